@@ -2,4 +2,27 @@
 #include "vstl/smart_ptr.hpp"
 #include "vstl/variadic_stuff.hpp"
 #include "vstl/string.hpp"
+#include "vstl/string_view.hpp"
+#include "vstl/string_search.hpp"
+#include "vstl/number_format.hpp"
 #include "vstl/vector2.hpp"
+#include "vstl/flat_map.hpp"
+#include "vstl/hash.hpp"
+#include "vstl/hash_map.hpp"
+#include "vstl/concurrent_hash_map.hpp"
+#include "vstl/ring_buffer.hpp"
+#include "vstl/concurrent_queue.hpp"
+#include "vstl/priority_queue.hpp"
+#include "vstl/persistent_vector.hpp"
+#include "vstl/slot_map.hpp"
+#include "vstl/object_pool.hpp"
+#include "vstl/allocator.hpp"
+#include "vstl/intern_pool.hpp"
+#include "vstl/rope.hpp"
+#include "vstl/shared_string.hpp"
+#include "vstl/string_sort.hpp"
+#include "vstl/string_table.hpp"
+#include "vstl/radix_trie.hpp"
+#include "vstl/utf8.hpp"
+#include "vstl/string_transform.hpp"
+#include "vstl/codec.hpp"
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "vstl/allocator.hpp"
+
+using namespace stdvector;
+
+TEST(CachingAllocatorTest, SizeClassesCoverEveryRequest) {
+  for (size_t idx = 0; idx < CachingAllocator::class_count; ++idx) {
+    size_t size = CachingAllocator::classSize(idx);
+    EXPECT_EQ(size % 16, 0u);
+    EXPECT_EQ(CachingAllocator::classIndex(size), idx);
+    if (idx > 0) {
+      EXPECT_GT(size, CachingAllocator::classSize(idx - 1));
+      EXPECT_EQ(CachingAllocator::classIndex(CachingAllocator::classSize(idx - 1) + 1), idx);
+    }
+  }
+  EXPECT_EQ(CachingAllocator::classSize(CachingAllocator::class_count - 1), CachingAllocator::max_small);
+  for (size_t bytes = 1; bytes <= CachingAllocator::max_small; ++bytes) {
+    size_t size = CachingAllocator::classSize(CachingAllocator::classIndex(bytes));
+    ASSERT_GE(size, bytes);
+    //at most a quarter wasted past the 16 byte steps
+    ASSERT_LE(size - bytes, bytes < 128 ? 15 : bytes / 4);
+  }
+}
+
+TEST(CachingAllocatorTest, SmallAndLargeRoundTrip) {
+  std::vector<std::pair<void*, size_t>> blocks;
+  for (size_t bytes : {1, 16, 17, 100, 129, 1000, 4096, 32768, 32769, 1 << 20}) {
+    void* ptr = CachingAllocator::allocate(bytes);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0u);
+    std::memset(ptr, 0xab, bytes);
+    blocks.emplace_back(ptr, bytes);
+  }
+  LargeStats large = CachingAllocator::largeStats();
+  EXPECT_GE(large.live_blocks, 2u);
+  for (const auto& block : blocks) {
+    CachingAllocator::deallocate(block.first, block.second);
+  }
+  EXPECT_EQ(CachingAllocator::largeStats().live_blocks, large.live_blocks - 2);
+  CachingAllocator::deallocate(nullptr, 64);
+}
+
+TEST(CachingAllocatorTest, ReusesFreedBlocks) {
+  size_t idx = CachingAllocator::classIndex(48);
+  void* first = CachingAllocator::allocate(48);
+  CachingAllocator::deallocate(first, 48);
+  void* second = CachingAllocator::allocate(40);
+  EXPECT_EQ(first, second);
+  CachingAllocator::deallocate(second, 40);
+  EXPECT_EQ(CachingAllocator::classStats(idx).block_size, 48u);
+}
+
+TEST(CachingAllocatorTest, ThreadsAllocateAndFree) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t] {
+      std::vector<std::pair<void*, size_t>> blocks;
+      for (int i = 0; i < 5000; ++i) {
+        size_t bytes = 8 + (i * 37 + t) % 2000;
+        void* ptr = CachingAllocator::allocate(bytes);
+        std::memset(ptr, t, bytes);
+        blocks.emplace_back(ptr, bytes);
+        if (i % 3 == 0) {
+          CachingAllocator::deallocate(blocks.back().first, blocks.back().second);
+          blocks.pop_back();
+        }
+      }
+      for (const auto& block : blocks) {
+        ASSERT_EQ(static_cast<unsigned char*>(block.first)[block.second - 1], t);
+        CachingAllocator::deallocate(block.first, block.second);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(AllocateBytesTest, AlignedOverload) {
+  for (size_t alignment : {8, 16, 64, 256, 4096}) {
+    void* ptr = allocateBytes(100, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0u);
+    deallocateBytes(ptr, 100, alignment);
+  }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "vstl/codec.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::string toStd(const String& str) {
+  return std::string(str.data(), str.size());
+}
+
+std::string randomBytes(std::mt19937& rng, size_t len) {
+  std::string bytes(len, '\0');
+  for (char& ch : bytes) {
+    ch = static_cast<char>(rng());
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TEST(CodecTest, Base64KnownVectors) {
+  //RFC 4648 section 10
+  const char* plain[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+  const char* padded[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+  const char* unpadded[] = {"", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE", "Zm9vYmFy"};
+  for (size_t i = 0; i < 7; ++i) {
+    EXPECT_EQ(base64Encode(plain[i]), padded[i]);
+    EXPECT_EQ(base64Encode(plain[i], Base64Alphabet::standard, false), unpadded[i]);
+    EXPECT_EQ(base64EncodedSize(std::strlen(plain[i])), std::strlen(padded[i]));
+    EXPECT_EQ(base64EncodedSize(std::strlen(plain[i]), false), std::strlen(unpadded[i]));
+  }
+  EXPECT_EQ(base64Encode("\xfb\xff", Base64Alphabet::url), "-_8=");
+  EXPECT_EQ(base64Encode("\xfb\xff"), "+/8=");
+}
+
+TEST(CodecTest, Base64RoundTrip) {
+  std::mt19937 rng(110);
+  //lengths across the 24 byte AVX2 step and the scalar tail
+  for (size_t len = 0; len < 130; ++len) {
+    std::string bytes = randomBytes(rng, len);
+    for (Base64Alphabet alphabet : {Base64Alphabet::standard, Base64Alphabet::url}) {
+      for (bool padding : {true, false}) {
+        String encoded("head:");
+        appendBase64(encoded, bytes.data(), bytes.size(), alphabet, padding);
+        ASSERT_EQ(encoded.size(), 5 + base64EncodedSize(len, padding));
+        ASSERT_EQ(encoded.c_str()[encoded.size()], '\0');
+        StringView text = StringView(encoded).substr(5);
+        ASSERT_EQ(base64DecodedSize(text), len);
+        String decoded("x");
+        ASSERT_EQ(appendBase64Decoded(decoded, text, alphabet), search_npos) << len;
+        ASSERT_EQ(toStd(decoded), "x" + bytes) << len;
+      }
+    }
+  }
+}
+
+TEST(CodecTest, Base64ErrorOffsets) {
+  std::mt19937 rng(111);
+  for (size_t len = 3; len < 100; len += 3) {
+    String encoded = base64Encode(StringView(randomBytes(rng, len).c_str(), len));
+    for (size_t at = 0; at < encoded.size(); ++at) {
+      String corrupt = encoded;
+      corrupt.data()[at] = '*';
+      String out("kept");
+      ASSERT_EQ(appendBase64Decoded(out, corrupt), at) << len;
+      ASSERT_EQ(out, "kept");
+    }
+  }
+  String out;
+  EXPECT_NE(appendBase64Decoded(out, "Zm9v-_8="), search_npos);
+  EXPECT_EQ(appendBase64Decoded(out, "Zm9v-_8=", Base64Alphabet::url), search_npos);
+  EXPECT_EQ(appendBase64Decoded(out, "Zg=a"), 2u);
+}
+
+TEST(CodecTest, HexRoundTrip) {
+  EXPECT_EQ(hexEncode("\x01\xab\xff"), "01abff");
+  EXPECT_EQ(hexEncode("\x01\xab\xff", true), "01ABFF");
+  std::mt19937 rng(112);
+  //lengths across the 16 byte encode and 32 char decode steps
+  for (size_t len = 0; len < 80; ++len) {
+    std::string bytes = randomBytes(rng, len);
+    for (bool upper : {false, true}) {
+      String encoded("0x");
+      appendHexEncoded(encoded, bytes.data(), bytes.size(), upper);
+      ASSERT_EQ(encoded.size(), 2 + 2 * len);
+      ASSERT_EQ(encoded.c_str()[encoded.size()], '\0');
+      String decoded;
+      ASSERT_EQ(appendHexDecoded(decoded, StringView(encoded).substr(2)), search_npos);
+      ASSERT_EQ(toStd(decoded), bytes);
+    }
+  }
+}
+
+TEST(CodecTest, HexErrorOffsets) {
+  std::mt19937 rng(113);
+  std::string bytes = randomBytes(rng, 40);
+  String encoded = hexEncode(StringView(bytes.data(), bytes.size()));
+  for (size_t at = 0; at < encoded.size(); ++at) {
+    for (char bad : {'g', 'G', '/', ':', '@', '`', '\xff'}) {
+      String corrupt = encoded;
+      corrupt.data()[at] = bad;
+      String out("kept");
+      ASSERT_EQ(appendHexDecoded(out, corrupt), at);
+      ASSERT_EQ(out, "kept");
+    }
+  }
+  String out("kept");
+  EXPECT_EQ(appendHexDecoded(out, "abc"), 3u);
+  EXPECT_EQ(out, "kept");
+  EXPECT_EQ(appendHexDecoded(out, "AbCd"), search_npos);
+  EXPECT_EQ(toStd(out), "kept\xab\xcd");
+}
+
+TEST(CodecTest, AppendReadsItsOwnOutput) {
+  //each append grows past the inline buffer or the current heap capacity
+  String hex("raw bytes");
+  appendHexEncoded(hex, hex.data(), hex.size());
+  EXPECT_EQ(toStd(hex), "raw bytes" + toStd(hexEncode("raw bytes")));
+  String decoded = hexEncode(String(40, '\x5a'));
+  ASSERT_EQ(appendHexDecoded(decoded, decoded), search_npos);
+  EXPECT_EQ(toStd(decoded), toStd(hexEncode(String(40, '\x5a'))) + std::string(40, 'Z'));
+
+  String base64("some bytes to encode");
+  appendBase64(base64, base64.data(), base64.size());
+  EXPECT_EQ(toStd(base64), "some bytes to encode" + toStd(base64Encode("some bytes to encode")));
+  String text = base64Encode(String(60, 'b'));
+  std::string expected = toStd(text) + std::string(60, 'b');
+  ASSERT_EQ(appendBase64Decoded(text, text), search_npos);
+  EXPECT_EQ(toStd(text), expected);
+}
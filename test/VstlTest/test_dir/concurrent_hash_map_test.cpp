@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vstl/concurrent_hash_map.hpp"
+#include "vstl/function.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(ConcurrentHashMapTest, ValueOverloadsWithConversions) {
+  ConcurrentHashMap<String, String> map(4);
+  map.insertOrAssign(String("k"), "abc");
+  EXPECT_TRUE(map.insert(String("j"), "def"));
+  String value;
+  ASSERT_TRUE(map.find(StringView("k"), value));
+  EXPECT_EQ(value, String("abc"));
+  map.insertOrAssign(String("k"), String("xyz"));
+  ASSERT_TRUE(map.find(StringView("k"), value));
+  EXPECT_EQ(value, String("xyz"));
+}
+
+TEST(ConcurrentHashMapTest, UpdaterAndFactory) {
+  ConcurrentHashMap<int, int> map(2);
+  auto increment = [](const int* current) { return current == nullptr ? 1 : *current + 1; };
+  EXPECT_EQ(map.insertOrAssign(7, increment), 1);
+  EXPECT_EQ(map.insertOrAssign(7, increment), 2);
+
+  vstl::Function<int, const int*> twice = [](const int* current) { return current == nullptr ? 0 : *current * 2; };
+  EXPECT_EQ(map.insertOrAssign(7, twice), 4);
+
+  int calls = 0;
+  auto factory = [&calls](const int& key) {
+    ++calls;
+    return key * 10;
+  };
+  EXPECT_EQ(map.computeIfAbsent(3, factory), 30);
+  EXPECT_EQ(map.computeIfAbsent(3, factory), 30);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(map.computeIfAbsent(7, factory), 4);
+}
+
+TEST(ConcurrentHashMapTest, ThrowingCallbackLeavesKeyAbsent) {
+  ConcurrentHashMap<int, int> map(2);
+  auto throwing_factory = [](const int&) -> int { throw std::runtime_error("factory"); };
+  EXPECT_THROW(map.computeIfAbsent(5, throwing_factory), std::runtime_error);
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_EQ(map.size(), size_t(0));
+  EXPECT_EQ(map.computeIfAbsent(5, [](const int& key) { return key + 1; }), 6);
+
+  auto throwing_updater = [](const int*) -> int { throw std::runtime_error("updater"); };
+  EXPECT_THROW(map.insertOrAssign(9, throwing_updater), std::runtime_error);
+  EXPECT_FALSE(map.contains(9));
+  EXPECT_THROW(map.insertOrAssign(5, throwing_updater), std::runtime_error);
+  int value = 0;
+  ASSERT_TRUE(map.find(5, value));
+  EXPECT_EQ(value, 6);
+}
+
+struct CountingHash {
+  static std::atomic<int> calls;
+  uint64_t operator()(int key) const {
+    ++calls;
+    return Hash<int>()(key);
+  }
+};
+std::atomic<int> CountingHash::calls{0};
+
+TEST(ConcurrentHashMapTest, HashesEachKeyOnce) {
+  ConcurrentHashMap<int, int, CountingHash> map(4);
+  map.reserve(64);
+  CountingHash::calls = 0;
+  map.insert(1, 10);
+  map.insertOrAssign(2, 20);
+  int value = 0;
+  EXPECT_TRUE(map.find(1, value));
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_EQ(map.computeIfAbsent(3, [](const int& key) { return key; }), 3);
+  EXPECT_TRUE(map.erase(2));
+  EXPECT_EQ(CountingHash::calls, 6);
+}
+
+TEST(ConcurrentHashMapTest, ParallelCounters) {
+  ConcurrentHashMap<int, int64_t> map(16);
+  const int thread_count = 4;
+  const int rounds = 20000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&map, t] {
+      for (int i = 0; i < rounds; ++i) {
+        map.insertOrAssign(i % 257, [](const int64_t* current) -> int64_t {
+          return current == nullptr ? 1 : *current + 1;
+        });
+        map.insert(100000 + t * rounds + i, i);
+        int64_t value;
+        map.find(i % 257, value);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t total = 0;
+  for (int key = 0; key < 257; ++key) {
+    int64_t value = 0;
+    ASSERT_TRUE(map.find(key, value));
+    total += value;
+  }
+  EXPECT_EQ(total, int64_t(thread_count) * rounds);
+  EXPECT_EQ(map.size(), size_t(257 + thread_count * rounds));
+}
+
+TEST(ConcurrentHashMapTest, ComputeIfAbsentRunsOncePerKey) {
+  ConcurrentHashMap<int, int> map(8);
+  std::atomic<int> calls{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int key = 0; key < 1000; ++key) {
+        int value = map.computeIfAbsent(key, [&calls](const int& k) {
+          calls.fetch_add(1);
+          return k + 1;
+        });
+        EXPECT_EQ(value, key + 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(calls.load(), 1000);
+  map.erase(5);
+  EXPECT_FALSE(map.contains(5));
+  map.clear();
+  EXPECT_EQ(map.size(), 0u);
+}
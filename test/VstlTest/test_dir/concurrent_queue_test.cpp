@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "vstl/concurrent_queue.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(SpscQueueTest, TryPushPopSingleThread) {
+  SpscQueue<int> queue(5);
+  EXPECT_EQ(queue.capacity(), 8u);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue.tryPush(i));
+  }
+  EXPECT_FALSE(queue.tryPush(8));
+  int out = -1;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(queue.tryPop(out));
+    EXPECT_EQ(out, i);
+  }
+  EXPECT_FALSE(queue.tryPop(out));
+
+  std::vector<int> src = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_EQ(queue.tryPushN(src.data(), src.size()), 8u);
+  std::vector<int> dst(10, 0);
+  EXPECT_EQ(queue.tryPopN(dst.data(), 10), 8u);
+  EXPECT_EQ(dst[7], 8);
+}
+
+TEST(SpscQueueTest, StaticCapacity) {
+  SpscQueue<int, 4, StaticMemory> queue;
+  EXPECT_EQ(queue.capacity(), 4u);
+  using Small = SpscQueue<int, 4, StaticMemory>;
+  EXPECT_THROW(Small(16), std::overflow_error);
+}
+
+TEST(SpscQueueTest, ProducerConsumerKeepsOrder) {
+  SpscQueue<String> queue(64);
+  const int count = 100000;
+  std::thread producer([&queue] {
+    for (int i = 0; i < count; ++i) {
+      String val;
+      val.appendInt(i);
+      queue.push(std::move(val));
+    }
+  });
+  for (int i = 0; i < count; ++i) {
+    String val;
+    queue.pop(val);
+    String expected;
+    expected.appendInt(i);
+    ASSERT_EQ(val, expected);
+  }
+  producer.join();
+  EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(MpmcQueueTest, ManyProducersManyConsumers) {
+  MpmcQueue<uint64_t> queue(128);
+  const int producer_count = 4;
+  const int consumer_count = 4;
+  const uint64_t per_producer = 50000;
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> popped{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producer_count; ++p) {
+    threads.emplace_back([&queue, p] {
+      for (uint64_t i = 1; i <= per_producer; ++i) {
+        uint64_t val = i + p * per_producer;
+        if (i % 3 == 0) {
+          while (queue.tryPushN(&val, 1) == 0) {
+            std::this_thread::yield();
+          }
+        } else {
+          queue.push(val);
+        }
+      }
+    });
+  }
+  const uint64_t total = producer_count * per_producer;
+  for (int c = 0; c < consumer_count; ++c) {
+    threads.emplace_back([&] {
+      uint64_t batch[16];
+      while (popped.load() < total) {
+        size_t got = queue.tryPopN(batch, 16);
+        for (size_t i = 0; i < got; ++i) {
+          sum.fetch_add(batch[i]);
+        }
+        popped.fetch_add(got);
+        if (got == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(popped.load(), total);
+  EXPECT_EQ(sum.load(), total * (total + 1) / 2);
+  EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(MpmcQueueTest, DestroysQueuedElements) {
+  MpmcQueue<String> queue(4);
+  EXPECT_TRUE(queue.tryPush(String("a string that has to be freed by the queue")));
+  EXPECT_TRUE(queue.tryPush(String("another one, also long enough for the heap")));
+  String out;
+  EXPECT_TRUE(queue.tryPop(out));
+  EXPECT_EQ(out, String("a string that has to be freed by the queue"));
+}
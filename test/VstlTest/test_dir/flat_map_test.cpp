@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vstl/flat_map.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(VectorTest, CopyReservesExactly) {
+  Vector<int> src;
+  for (int i = 0; i < 1000; ++i) {
+    src.pushBack(i);
+  }
+  Vector<int> copy(src);
+  EXPECT_EQ(copy.size(), 1000u);
+  EXPECT_EQ(copy.capacity(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(copy[i], i);
+  }
+
+  Vector<int> assigned;
+  assigned.pushBack(7);
+  assigned = src;
+  EXPECT_EQ(assigned.size(), 1000u);
+  EXPECT_EQ(assigned[999], 999);
+}
+
+TEST(VectorTest, MoveStealsBuffer) {
+  Vector<String> src;
+  for (int i = 0; i < 100; ++i) {
+    src.pushBack(String("a fairly long string that lives on the heap"));
+  }
+  const String* buffer = src.data();
+  Vector<String> moved(std::move(src));
+  EXPECT_EQ(moved.data(), buffer);
+  EXPECT_EQ(moved.size(), 100u);
+  EXPECT_EQ(src.size(), 0u);
+
+  //moved-from vector stays usable
+  src.pushBack(String("x"));
+  EXPECT_EQ(src.size(), 1u);
+  EXPECT_EQ(src[0], String("x"));
+
+  Vector<String> assigned;
+  assigned.pushBack(String("old"));
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.data(), buffer);
+  EXPECT_EQ(assigned.size(), 100u);
+  EXPECT_EQ(moved.size(), 0u);
+}
+
+TEST(VectorTest, MoveStaticMemory) {
+  Vector<String, 8, StaticMemory> src;
+  src.pushBack(String("one"));
+  src.pushBack(String("two"));
+  Vector<String, 8, StaticMemory> moved(std::move(src));
+  ASSERT_EQ(moved.size(), 2u);
+  EXPECT_EQ(moved[1], String("two"));
+  EXPECT_EQ(src.size(), 0u);
+}
+
+TEST(VectorTest, StaticMemoryConstructsCount) {
+  String heap("a fairly long string that lives on the heap");
+  Vector<String, 8, StaticMemory> filled(3, heap);
+  ASSERT_EQ(filled.size(), 3u);
+  EXPECT_EQ(filled[2], heap);
+  Vector<String, 8, StaticMemory> defaulted(5);
+  ASSERT_EQ(defaulted.size(), 5u);
+  EXPECT_EQ(defaulted[4], String());
+  using Small = Vector<String, 8, StaticMemory>;
+  EXPECT_THROW(Small(9), std::overflow_error);
+  EXPECT_THROW(Small(9, heap), std::overflow_error);
+}
+
+TEST(VectorTest, Reserve) {
+  Vector<int> v;
+  v.pushBack(1);
+  v.reserve(500);
+  EXPECT_GE(v.capacity(), 500u);
+  EXPECT_EQ(v.size(), 1u);
+  EXPECT_EQ(v[0], 1);
+}
+
+TEST(FlatSetTest, MatchesStdSet) {
+  std::mt19937 rng(1);
+  FlatSet<int> flat;
+  std::set<int> expected;
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(rng() % 1000);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(flat.erase(key), expected.erase(key) == 1);
+    } else {
+      EXPECT_EQ(flat.insert(key), expected.insert(key).second);
+    }
+  }
+  ASSERT_EQ(flat.size(), expected.size());
+  size_t idx = 0;
+  for (int key : expected) {
+    EXPECT_EQ(flat[idx++], key);
+  }
+}
+
+TEST(FlatSetTest, BulkInsert) {
+  std::vector<int> keys = {5, 3, 9, 3, 1, 5};
+  FlatSet<int> flat(keys.begin(), keys.end());
+  std::vector<int> more = {2, 9, 10};
+  flat.insert(more.begin(), more.end());
+  std::vector<int> got(flat.begin(), flat.end());
+  EXPECT_EQ(got, (std::vector<int>{1, 2, 3, 5, 9, 10}));
+}
+
+TEST(FlatMapTest, MatchesStdMap) {
+  std::mt19937 rng(2);
+  FlatMap<int, int> flat;
+  std::map<int, int> expected;
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(rng() % 1000);
+    int value = static_cast<int>(rng());
+    switch (rng() % 4) {
+      case 0:
+        EXPECT_EQ(flat.erase(key), expected.erase(key) == 1);
+        break;
+      case 1:
+        flat.insertOrAssign(key, value);
+        expected[key] = value;
+        break;
+      case 2:
+        EXPECT_EQ(flat.insert(key, value), expected.emplace(key, value).second);
+        break;
+      default:
+        flat[key] += 1;
+        expected[key] += 1;
+    }
+  }
+  ASSERT_EQ(flat.size(), expected.size());
+  size_t idx = 0;
+  for (const auto& item : expected) {
+    EXPECT_EQ(flat.keyAt(idx), item.first);
+    EXPECT_EQ(flat.valueAt(idx), item.second);
+    ++idx;
+  }
+  EXPECT_EQ(flat.find(-1), nullptr);
+}
+
+TEST(FlatMapTest, BulkInsertKeepsFirstAndExisting) {
+  FlatMap<int, std::string> flat{{1, "one"}};
+  std::vector<std::pair<int, std::string>> items = {{3, "three"}, {1, "uno"}, {2, "two"}, {3, "tres"}};
+  flat.insert(items.begin(), items.end());
+  ASSERT_EQ(flat.size(), 3u);
+  EXPECT_EQ(*flat.find(1), "one");
+  EXPECT_EQ(*flat.find(2), "two");
+  EXPECT_EQ(*flat.find(3), "three");
+}
+
+TEST(FlatMapTest, HeterogeneousStringLookup) {
+  FlatMap<String, int> flat;
+  flat.insert(String("beta"), 2);
+  flat.insert(String("alpha"), 1);
+  ASSERT_NE(flat.find("alpha"), nullptr);
+  EXPECT_EQ(*flat.find("alpha"), 1);
+  EXPECT_TRUE(flat.contains("beta"));
+  EXPECT_FALSE(flat.contains("gamma"));
+}
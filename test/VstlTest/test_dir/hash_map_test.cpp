@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include "vstl/hash_map.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(HashMapTest, MatchesUnorderedMap) {
+  std::mt19937 rng(3);
+  HashMap<uint64_t, uint64_t> map;
+  std::unordered_map<uint64_t, uint64_t> expected;
+  for (int i = 0; i < 50000; ++i) {
+    uint64_t key = rng() % 4000;
+    uint64_t value = rng();
+    switch (rng() % 4) {
+      case 0:
+        EXPECT_EQ(map.erase(key), expected.erase(key) == 1);
+        break;
+      case 1:
+        map.insertOrAssign(key, value);
+        expected[key] = value;
+        break;
+      case 2:
+        EXPECT_EQ(map.insert(key, value), expected.emplace(key, value).second);
+        break;
+      default:
+        map[key] += 1;
+        expected[key] += 1;
+    }
+  }
+  ASSERT_EQ(map.size(), expected.size());
+  for (const auto& item : expected) {
+    const uint64_t* value = map.find(item.first);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, item.second);
+  }
+  size_t visited = 0;
+  for (const auto& slot : map) {
+    EXPECT_EQ(expected.at(slot.first), slot.second);
+    ++visited;
+  }
+  EXPECT_EQ(visited, expected.size());
+}
+
+TEST(HashMapTest, EraseEverythingThenReuse) {
+  HashMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(i, i * 2);
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(map.erase(i));
+  }
+  for (int i = 1; i < 1000; i += 2) {
+    ASSERT_NE(map.find(i), nullptr);
+    EXPECT_EQ(*map.find(i), i * 2);
+  }
+  for (int i = 1; i < 1000; i += 2) {
+    EXPECT_TRUE(map.erase(i));
+  }
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  map.insert(5, 6);
+  EXPECT_EQ(*map.find(5), 6);
+}
+
+TEST(HashMapTest, TransparentStringLookup) {
+  HashMap<String, int> map;
+  map.insert(String("apple"), 1);
+  map.insert(String("a key long enough to leave the inline buffer"), 2);
+  EXPECT_TRUE(map.contains(StringView("apple")));
+  ASSERT_NE(map.find(StringView("a key long enough to leave the inline buffer")), nullptr);
+  EXPECT_EQ(*map.find(StringView("a key long enough to leave the inline buffer")), 2);
+  EXPECT_EQ(map.find(StringView("pear")), nullptr);
+}
+
+TEST(HashMapTest, IteratorsExposeConstKeys) {
+  using Map = HashMap<int, int>;
+  static_assert(std::is_const<std::remove_reference_t<decltype(std::declval<Map::Iterator>()->first)>>::value,
+                "keys must not be writable through an iterator");
+  static_assert(std::is_const<std::remove_reference_t<decltype(*std::declval<Map::ConstIterator>())>>::value,
+                "const iterator must yield const slots");
+
+  Map map;
+  map.insert(1, 10);
+  for (auto& slot : map) {
+    slot.second += 1;
+  }
+  const Map& view = map;
+  Map::ConstIterator it = view.begin();
+  EXPECT_EQ(it->second, 11);
+  Map::ConstIterator converted = map.begin();
+  EXPECT_EQ(converted, it);
+}
+
+struct alignas(64) Wide {
+  int value;
+};
+
+TEST(HashMapTest, OverAlignedValues) {
+  HashMap<int, Wide> map;
+  for (int i = 0; i < 200; ++i) {
+    map.insert(i, Wide{i});
+  }
+  for (int i = 0; i < 200; ++i) {
+    const Wide* wide = map.find(i);
+    ASSERT_NE(wide, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(wide) % 64, 0u);
+    EXPECT_EQ(wide->value, i);
+  }
+}
+
+TEST(HashMapTest, CopyAndMove) {
+  HashMap<String, int> map;
+  for (int i = 0; i < 100; ++i) {
+    map.insert(String(std::to_string(i).c_str()), i);
+  }
+  HashMap<String, int> copy(map);
+  HashMap<String, int> moved(std::move(map));
+  EXPECT_EQ(copy.size(), 100u);
+  EXPECT_EQ(moved.size(), 100u);
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(*copy.find(StringView("42")), 42);
+  EXPECT_EQ(*moved.find(StringView("99")), 99);
+}
+
+TEST(HashMapTest, InsertFromOwnSlotAcrossGrowth) {
+  HashMap<String, String> map;
+  map.insert(String("seed"), String("a value long enough to live on the heap"));
+  for (int i = 0; i < 200; ++i) {
+    String key(std::to_string(i).c_str());
+    if (i % 2 == 0) {
+      map.insert(key, *map.find(StringView("seed")));
+    } else {
+      map.insertOrAssign(key, *map.find(StringView("seed")));
+    }
+  }
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    EXPECT_EQ(it->second, String("a value long enough to live on the heap"));
+  }
+  EXPECT_EQ(map.size(), 201u);
+}
+
+struct CountingHash {
+  static int calls;
+  uint64_t operator()(uint64_t key) const {
+    ++calls;
+    return Hash<uint64_t>()(key);
+  }
+};
+int CountingHash::calls = 0;
+
+TEST(HashMapTest, EraseAndRehashDoNotRehashKeys) {
+  HashMap<uint64_t, int, CountingHash> map;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    map.insert(i, 0);
+  }
+  CountingHash::calls = 0;
+  map.rehash(map.capacity() * 4);
+  EXPECT_EQ(CountingHash::calls, 0);
+  for (uint64_t i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(map.erase(i));
+  }
+  EXPECT_EQ(CountingHash::calls, 500);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(map.contains(i), i % 2 == 1);
+  }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "vstl/hash.hpp"
+#include "vstl/hash_map.hpp"
+
+using namespace stdvector;
+
+TEST(HashTest, DependsOnContentsOnly) {
+  std::mt19937 rng(41);
+  std::vector<char> source(300);
+  for (char& ch : source) {
+    ch = static_cast<char>(rng());
+  }
+  //same bytes at every alignment and every length through the 16/48 byte paths
+  for (size_t len = 0; len <= 200; ++len) {
+    uint64_t expected = hashBytes(source.data(), len);
+    for (size_t shift = 1; shift < 8; ++shift) {
+      std::vector<char> copy(len + shift);
+      std::memcpy(copy.data() + shift, source.data(), len);
+      ASSERT_EQ(hashBytes(copy.data() + shift, len), expected) << len;
+    }
+  }
+}
+
+TEST(HashTest, EveryLengthAndByteMatters) {
+  std::string text(120, 'x');
+  std::unordered_set<uint64_t> seen;
+  for (size_t len = 0; len <= text.size(); ++len) {
+    EXPECT_TRUE(seen.insert(hashBytes(text.data(), len)).second) << len;
+  }
+  for (size_t at = 0; at < text.size(); ++at) {
+    std::string changed = text;
+    changed[at] = 'y';
+    EXPECT_TRUE(seen.insert(hashBytes(changed.data(), changed.size())).second) << at;
+  }
+  EXPECT_NE(hashBytes(text.data(), 10, 1), hashBytes(text.data(), 10, 2));
+}
+
+TEST(HashTest, SingleBitFlipsAvalanche) {
+  std::mt19937_64 rng(42);
+  const size_t lengths[] = {3, 8, 16, 31, 64, 100};
+  for (size_t len : lengths) {
+    std::vector<unsigned char> bytes(len);
+    double flipped = 0;
+    int trials = 0;
+    for (int round = 0; round < 50; ++round) {
+      for (unsigned char& byte : bytes) {
+        byte = static_cast<unsigned char>(rng());
+      }
+      uint64_t base = hashBytes(bytes.data(), len);
+      for (size_t bit = 0; bit < len * 8; bit += 3) {
+        bytes[bit / 8] ^= static_cast<unsigned char>(1 << (bit % 8));
+        flipped += __builtin_popcountll(base ^ hashBytes(bytes.data(), len));
+        bytes[bit / 8] ^= static_cast<unsigned char>(1 << (bit % 8));
+        ++trials;
+      }
+    }
+    double average = flipped / trials;
+    EXPECT_GT(average, 30.0) << len;
+    EXPECT_LT(average, 34.0) << len;
+  }
+}
+
+TEST(HashTest, LowBitsSpreadSequentialKeys) {
+  const size_t buckets = 1024;
+  std::vector<int> counts(buckets);
+  std::vector<int> int_counts(buckets);
+  for (int i = 0; i < 100 * static_cast<int>(buckets); ++i) {
+    String key("key");
+    key.appendInt(i);
+    ++counts[Hash<String>()(key) & (buckets - 1)];
+    ++int_counts[Hash<int>()(i) & (buckets - 1)];
+  }
+  for (size_t b = 0; b < buckets; ++b) {
+    ASSERT_GT(counts[b], 50);
+    ASSERT_LT(counts[b], 150);
+    ASSERT_GT(int_counts[b], 50);
+    ASSERT_LT(int_counts[b], 150);
+  }
+}
+
+TEST(HashTest, TransparentStringHashes) {
+  String str("transparent key");
+  Hash<String> hasher;
+  EXPECT_EQ(hasher(str), hasher("transparent key"));
+  EXPECT_EQ(hasher(str), hasher(StringView("transparent key")));
+  EXPECT_EQ(Hash<StringView>()(StringView(str)), hasher(str));
+}
+
+TEST(HashTest, CombinatorsAreOrdered) {
+  EXPECT_NE(hashValues(1, 2), hashValues(2, 1));
+  EXPECT_EQ(hashValues(1, String("a"), 3), hashValues(1, String("a"), 3));
+  EXPECT_EQ((Hash<std::pair<int, int>>()(std::make_pair(4, 5))), hashCombine(Hash<int>()(4), Hash<int>()(5)));
+  EXPECT_NE(hashCombine(1, 2), hashCombine(2, 1));
+}
+
+TEST(HashedStringTest, CachesTheStringHash) {
+  HashedString str("cached");
+  EXPECT_EQ(str.hash(), Hash<String>()(String("cached")));
+  EXPECT_EQ(Hash<HashedString>()(str), str.hash());
+  HashedString copy(str);
+  EXPECT_EQ(copy.hash(), str.hash());
+  HashedString moved(std::move(copy));
+  EXPECT_EQ(moved.hash(), str.hash());
+  EXPECT_EQ(moved, str);
+}
+
+TEST(HashedStringTest, MutationsDropTheHash) {
+  HashedString str("abc");
+  uint64_t before = str.hash();
+  str += "d";
+  EXPECT_EQ(str.hash(), Hash<String>()(String("abcd")));
+  str.pop_back();
+  EXPECT_EQ(str.hash(), before);
+  str.push_back('z');
+  EXPECT_EQ(str.hash(), Hash<String>()(String("abcz")));
+  str.modify([](String& raw) { raw.resize(1); });
+  EXPECT_EQ(str.hash(), Hash<String>()(String("a")));
+  EXPECT_NE(str, HashedString("abcz"));
+  EXPECT_EQ(str, HashedString("a"));
+}
+
+TEST(HashedStringTest, HashMapProbedWithViews) {
+  HashMap<HashedString, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(HashedString(String("k").appendInt(i)), i);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    String key = String("k").appendInt(i);
+    const int* found = map.find(StringView(key));
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(*found, i);
+  }
+  EXPECT_EQ(map.find(StringView("k1000")), nullptr);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "vstl/intern_pool.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(InternPoolTest, EqualContentEqualId) {
+  InternPool pool;
+  InternedString a = pool.intern("apple");
+  InternedString b = pool.intern(String("apple"));
+  InternedString c = pool.intern("banana");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.c_str(), b.c_str());
+  EXPECT_NE(a, c);
+  EXPECT_STREQ(a.c_str(), "apple");
+  EXPECT_EQ(a.size(), 5u);
+  EXPECT_EQ(StringView(c), StringView("banana"));
+  EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(InternPoolTest, EmptyAndEmbeddedNul) {
+  InternPool pool;
+  InternedString none;
+  EXPECT_EQ(none.size(), 0u);
+  EXPECT_STREQ(none.c_str(), "");
+  InternedString empty = pool.intern("");
+  EXPECT_EQ(empty.size(), 0u);
+  EXPECT_NE(empty.id(), InternedString::npos);
+  const char raw[] = {'a', '\0', 'b'};
+  InternedString with_nul = pool.intern(StringView(raw, 3));
+  EXPECT_EQ(with_nul.size(), 3u);
+  EXPECT_NE(with_nul, pool.intern("a"));
+}
+
+TEST(InternPoolTest, FindAndGet) {
+  InternPool pool(4);
+  InternedString out;
+  EXPECT_FALSE(pool.find("missing", out));
+  EXPECT_EQ(pool.size(), 0u);
+  InternedString kept = pool.intern("kept");
+  ASSERT_TRUE(pool.find("kept", out));
+  EXPECT_EQ(out, kept);
+  EXPECT_EQ(pool.get(kept.id()).c_str(), kept.c_str());
+}
+
+TEST(InternPoolTest, ShardCountLeavesRoomForIds) {
+  EXPECT_THROW(InternPool((size_t(1) << 31) + 1), std::invalid_argument);
+  EXPECT_THROW(InternPool(size_t(1) << 40), std::invalid_argument);
+  InternPool single(1);
+  EXPECT_EQ(single.shardCount(), 1u);
+  EXPECT_EQ(single.intern("x").id(), 0u);
+  EXPECT_EQ(single.intern("y").id(), 1u);
+}
+
+TEST(InternPoolTest, ManyStringsKeepTheirCharacters) {
+  InternPool pool(8);
+  std::vector<InternedString> handles;
+  for (int i = 0; i < 20000; ++i) {
+    handles.push_back(pool.intern(String("key-").appendInt(i)));
+  }
+  String big(100000, 'b');
+  InternedString big_handle = pool.intern(big);
+  EXPECT_EQ(pool.size(), 20001u);
+  for (int i = 0; i < 20000; ++i) {
+    String expected = String("key-").appendInt(i);
+    ASSERT_EQ(StringView(handles[i]), StringView(expected));
+    ASSERT_EQ(pool.get(handles[i].id()), handles[i]);
+  }
+  EXPECT_EQ(StringView(big_handle), StringView(big));
+}
+
+TEST(InternPoolTest, InternAllMatchesIntern) {
+  InternPool pool;
+  Vector<String> column;
+  for (int i = 0; i < 1000; ++i) {
+    column.pushBack(String("v").appendInt(i % 37));
+  }
+  Vector<InternedString> ids = pool.internAll(column);
+  ASSERT_EQ(ids.size(), column.size());
+  for (size_t i = 0; i < column.size(); ++i) {
+    EXPECT_EQ(ids.data()[i], pool.intern(column.data()[i]));
+  }
+  EXPECT_EQ(pool.size(), 37u);
+}
+
+TEST(InternPoolTest, ThreadsAgreeOnIds) {
+  InternPool pool;
+  const int thread_count = 4;
+  const int key_count = 5000;
+  std::vector<std::vector<uint32_t>> seen(thread_count, std::vector<uint32_t>(key_count));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&pool, &seen, t, key_count] {
+      for (int k = 0; k < key_count; ++k) {
+        int key = (k * 7 + t * 13) % key_count;
+        seen[t][key] = pool.intern(String("shared-").appendInt(key)).id();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(pool.size(), static_cast<size_t>(key_count));
+  std::unordered_map<uint32_t, int> owner;
+  for (int k = 0; k < key_count; ++k) {
+    for (int t = 1; t < thread_count; ++t) {
+      ASSERT_EQ(seen[t][k], seen[0][k]);
+    }
+    EXPECT_TRUE(owner.emplace(seen[0][k], k).second);
+  }
+}
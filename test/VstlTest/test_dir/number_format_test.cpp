@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "vstl/number_format.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::string formatted(const char* format, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  std::vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return buf;
+}
+
+}  // namespace
+
+TEST(NumberFormatTest, IntegersMatchPrintf) {
+  std::mt19937_64 rng(31);
+  const int64_t edges[] = {0, 1, -1, 9, 10, 99, 100, -100, std::numeric_limits<int64_t>::max(),
+                           std::numeric_limits<int64_t>::min()};
+  for (int64_t value : edges) {
+    EXPECT_EQ(std::string(String().appendInt(value).c_str()), formatted("%" PRId64, value));
+  }
+  for (int i = 0; i < 2000; ++i) {
+    uint64_t bits = rng() >> (rng() % 64);
+    int64_t value = static_cast<int64_t>(i % 2 ? bits : 0 - bits);
+    ASSERT_EQ(std::string(String().appendInt(value).c_str()), formatted("%" PRId64, value));
+    ASSERT_EQ(std::string(String().appendUInt(bits).c_str()), formatted("%" PRIu64, bits));
+    ASSERT_EQ(std::string(String().appendHex(bits).c_str()), formatted("%" PRIx64, bits));
+  }
+  EXPECT_EQ(std::string(String().appendUInt(std::numeric_limits<uint64_t>::max()).c_str()),
+            "18446744073709551615");
+}
+
+TEST(NumberFormatTest, WidthPadsWithZeros) {
+  EXPECT_EQ(String().appendInt(42, 5), "00042");
+  EXPECT_EQ(String().appendInt(-42, 5), "-00042");
+  EXPECT_EQ(String().appendUInt(123456, 3), "123456");
+  EXPECT_EQ(String().appendHex(0xab, 4, true), "00AB");
+}
+
+TEST(NumberFormatTest, IntegersReserveExactly) {
+  String str("x=");
+  str.appendInt(-12345);
+  EXPECT_EQ(str, "x=-12345");
+  EXPECT_EQ(str.capacity(), 22u);
+}
+
+TEST(NumberFormatTest, DoubleRoundTrips) {
+  std::mt19937_64 rng(32);
+  for (int i = 0; i < 2000; ++i) {
+    uint64_t bits = rng();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value != value || value - value != 0) {
+      continue;
+    }
+    String str;
+    str.appendDouble(value);
+    double parsed = 0;
+    ASSERT_EQ(parseDouble(str, parsed), str.size()) << str;
+    ASSERT_EQ(parsed, value) << str;
+  }
+}
+
+TEST(NumberFormatTest, FixedStaysInline) {
+  String str("x=");
+  str.appendFixed(1.5, 2);
+  EXPECT_EQ(str, "x=1.50");
+  EXPECT_EQ(str.capacity(), 22u);
+  EXPECT_EQ(String().appendFixed(-0.125, 3), "-0.125");
+  EXPECT_EQ(std::string(String().appendFixed(1e300, 1).c_str()), formatted("%.1f", 1e300));
+  EXPECT_EQ(std::string(String().appendFixed(-1.7976931348623157e308, 0).c_str()),
+            formatted("%.0f", -1.7976931348623157e308));
+}
+
+TEST(NumberFormatTest, FixedPrecisionIsClamped) {
+  EXPECT_EQ(String().appendFixed(2.5, -3), String().appendFixed(2.5, 0));
+  EXPECT_EQ(String().appendFixed(0.1, 1000), String().appendFixed(0.1, max_fixed_precision));
+  EXPECT_EQ(String().appendFixed(0.1, 1000).size(), 2u + max_fixed_precision);
+  char buf[max_fixed_chars];
+  EXPECT_EQ(std::string(buf, writeFixed(buf, 3.25, -1)), "3");
+}
+
+TEST(NumberFormatTest, ParseIntegers) {
+  uint64_t unsigned_out = 7;
+  EXPECT_EQ(parseUInt("18446744073709551615", unsigned_out), 20u);
+  EXPECT_EQ(unsigned_out, std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(parseUInt("18446744073709551616", unsigned_out), 0u);
+  EXPECT_EQ(unsigned_out, std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(parseUInt("12345678901234x", unsigned_out), 14u);
+  EXPECT_EQ(unsigned_out, 12345678901234u);
+  EXPECT_EQ(parseUInt("x1", unsigned_out), 0u);
+
+  int64_t signed_out = 0;
+  EXPECT_EQ(parseInt("-9223372036854775808", signed_out), 20u);
+  EXPECT_EQ(signed_out, std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(parseInt("9223372036854775808", signed_out), 0u);
+  EXPECT_EQ(parseInt("+17 apples", signed_out), 3u);
+  EXPECT_EQ(signed_out, 17);
+  EXPECT_EQ(parseInt("-", signed_out), 0u);
+
+  EXPECT_EQ(parseHex("DeadBeef!", unsigned_out), 8u);
+  EXPECT_EQ(unsigned_out, 0xdeadbeefu);
+  EXPECT_EQ(parseHex("ffffffffffffffff", unsigned_out), 16u);
+  EXPECT_EQ(parseHex("10000000000000000", unsigned_out), 0u);
+  EXPECT_EQ(parseHex("00000000000000001", unsigned_out), 17u);
+  EXPECT_EQ(unsigned_out, 1u);
+  EXPECT_EQ(parseHex("0000ffffffffffffffff", unsigned_out), 20u);
+  EXPECT_EQ(unsigned_out, ~uint64_t(0));
+  EXPECT_EQ(parseHex("000", unsigned_out), 3u);
+  EXPECT_EQ(unsigned_out, 0u);
+}
+
+TEST(NumberFormatTest, ParseIntegerRoundTrips) {
+  std::mt19937_64 rng(33);
+  for (int i = 0; i < 2000; ++i) {
+    uint64_t bits = rng() >> (rng() % 64);
+    int64_t value = static_cast<int64_t>(i % 2 ? bits : 0 - bits);
+    String str;
+    str.appendInt(value);
+    int64_t parsed = 0;
+    ASSERT_EQ(parseInt(str, parsed), str.size());
+    ASSERT_EQ(parsed, value);
+  }
+}
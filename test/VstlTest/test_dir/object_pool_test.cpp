@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "vstl/object_pool.hpp"
+#include "vstl/smart_ptr.hpp"
+
+using namespace stdvector;
+
+TEST(ObjectPoolTest, BlocksAreAlignedAndDistinct) {
+  using Pool = FixedPool<24, 32>;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    void* ptr = Pool::allocate();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 32, 0u);
+    std::memset(ptr, i & 0xff, 24);
+    blocks.push_back(ptr);
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    EXPECT_EQ(static_cast<unsigned char*>(blocks[i])[23], i & 0xff);
+    Pool::deallocate(blocks[i]);
+  }
+}
+
+//a consumer thread that only frees must hand its cache back on exit
+TEST(ObjectPoolTest, FreeOnlyThreadReturnsItsCache) {
+  using Pool = FixedPool<1000, 64>;
+  const size_t count = 3 * Pool::batch;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < count; ++i) {
+    blocks.push_back(Pool::allocate());
+  }
+  size_t outstanding = Pool::stats().outstanding;
+  EXPECT_GE(outstanding, count);
+
+  std::thread consumer([&blocks] {
+    for (void* ptr : blocks) {
+      Pool::deallocate(ptr);
+    }
+  });
+  consumer.join();
+  EXPECT_EQ(Pool::stats().outstanding, outstanding - count);
+}
+
+struct Tracked {
+  static int alive;
+  int value;
+  explicit Tracked(int v) : value(v) {
+    ++alive;
+  }
+  ~Tracked() {
+    --alive;
+  }
+};
+int Tracked::alive = 0;
+
+TEST(ObjectPoolTest, CreateDestroyAndSharedPtrBlocks) {
+  Tracked* tracked = ObjectPool<Tracked>::create(5);
+  EXPECT_EQ(tracked->value, 5);
+  EXPECT_EQ(Tracked::alive, 1);
+  ObjectPool<Tracked>::destroy(tracked);
+  EXPECT_EQ(Tracked::alive, 0);
+
+  {
+    std::vector<smart_ptr::SharedPtr<Tracked>> ptrs;
+    for (int i = 0; i < 500; ++i) {
+      ptrs.push_back(smart_ptr::MakeShared<Tracked>(i));
+      ptrs.push_back(smart_ptr::SharedPtr<Tracked>(new Tracked(i)));
+    }
+    EXPECT_EQ(Tracked::alive, 1000);
+    std::vector<smart_ptr::SharedPtr<Tracked>> copies(ptrs);
+    EXPECT_EQ(copies[10].count(), 2u);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(ObjectPoolTest, CrossThreadFrees) {
+  std::vector<smart_ptr::SharedPtr<Tracked>> ptrs;
+  for (int i = 0; i < 2000; ++i) {
+    ptrs.push_back(smart_ptr::MakeShared<Tracked>(i));
+  }
+  std::thread consumer([ptrs = std::move(ptrs)]() mutable { ptrs.clear(); });
+  consumer.join();
+  EXPECT_EQ(Tracked::alive, 0);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "vstl/persistent_vector.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(PersistentVectorTest, PushBackKeepsOldVersions) {
+  std::vector<PersistentVector<int>> versions;
+  PersistentVector<int> vec;
+  versions.push_back(vec);
+  const int count = 40000;
+  for (int i = 0; i < count; ++i) {
+    vec = vec.pushBack(i);
+    if (i % 1000 == 999) {
+      versions.push_back(vec);
+    }
+  }
+  ASSERT_EQ(vec.size(), size_t(count));
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(vec[i], i);
+  }
+  for (size_t v = 0; v < versions.size(); ++v) {
+    ASSERT_EQ(versions[v].size(), v * 1000);
+    for (size_t i = 0; i < versions[v].size(); i += 97) {
+      EXPECT_EQ(versions[v][i], static_cast<int>(i));
+    }
+  }
+}
+
+TEST(PersistentVectorTest, SetMatchesReference) {
+  std::mt19937 rng(7);
+  PersistentVector<int> vec;
+  std::vector<int> expected;
+  for (int i = 0; i < 5000; ++i) {
+    vec = vec.pushBack(i);
+    expected.push_back(i);
+  }
+  PersistentVector<int> original = vec;
+  for (int i = 0; i < 5000; ++i) {
+    size_t idx = rng() % expected.size();
+    int val = static_cast<int>(rng());
+    vec = vec.set(idx, val);
+    expected[idx] = val;
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(vec[i], expected[i]);
+    ASSERT_EQ(original[i], static_cast<int>(i));
+  }
+}
+
+TEST(PersistentVectorTest, TransientBatchAndSnapshots) {
+  TransientVector<String> builder;
+  for (int i = 0; i < 3000; ++i) {
+    String val;
+    val.appendInt(i);
+    builder.pushBack(val);
+  }
+  PersistentVector<String> frozen = builder.persistent();
+  builder.set(5, String("changed"));
+  builder.set(2999, String("tail"));
+  String extra("extra");
+  builder.pushBack(extra);
+
+  PersistentVector<String> after = builder.persistent();
+  EXPECT_EQ(frozen.size(), 3000u);
+  EXPECT_EQ(frozen[5], String("5"));
+  EXPECT_EQ(frozen[2999], String("2999"));
+  EXPECT_EQ(after.size(), 3001u);
+  EXPECT_EQ(after[5], String("changed"));
+  EXPECT_EQ(after[2999], String("tail"));
+  EXPECT_EQ(after[3000], String("extra"));
+
+  TransientVector<String> again = frozen.transient();
+  again.set(0, String("zero"));
+  EXPECT_EQ(again[0], String("zero"));
+  EXPECT_EQ(frozen[0], String("0"));
+}
+
+struct Base {
+  int base_value = 1;
+};
+struct Derived : Base {
+  int derived_value = 2;
+};
+
+TEST(SharedPtrTest, DerivedToBaseSharesOwnership) {
+  smart_ptr::SharedPtr<Derived> derived = smart_ptr::MakeShared<Derived>();
+  smart_ptr::SharedPtr<Base> base = derived;
+  EXPECT_EQ(derived.count(), 2u);
+  EXPECT_EQ(base.get(), derived.get());
+  smart_ptr::SharedPtr<Base> moved = std::move(derived);
+  EXPECT_FALSE(derived);
+  EXPECT_EQ(moved.count(), 2u);
+  base.reset();
+  EXPECT_EQ(moved.count(), 1u);
+  EXPECT_EQ(moved->base_value, 1);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "vstl/priority_queue.hpp"
+
+using namespace stdvector;
+
+TEST(PriorityQueueTest, MatchesStdPriorityQueue) {
+  std::mt19937 rng(5);
+  PriorityQueue<int> heap;
+  std::priority_queue<int> expected;
+  for (int i = 0; i < 20000; ++i) {
+    if (expected.empty() || rng() % 3 != 0) {
+      int val = static_cast<int>(rng() % 100000);
+      heap.push(val);
+      expected.push(val);
+    } else {
+      ASSERT_EQ(heap.top(), expected.top());
+      heap.pop();
+      expected.pop();
+    }
+  }
+  while (!expected.empty()) {
+    ASSERT_EQ(heap.top(), expected.top());
+    heap.pop();
+    expected.pop();
+  }
+  EXPECT_TRUE(heap.empty());
+}
+
+TEST(PriorityQueueTest, MinHeapWithBinaryArity) {
+  PriorityQueue<int, std::greater<int>, 2> heap;
+  for (int val : {5, 1, 4, 2, 3}) {
+    heap.push(val);
+  }
+  std::vector<int> order;
+  while (!heap.empty()) {
+    order.push_back(heap.top());
+    heap.pop();
+  }
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3, 4, 5}));
+}
+
+TEST(PriorityQueueTest, UpdateAndEraseByHandle) {
+  std::mt19937 rng(6);
+  PriorityQueue<int> heap;
+  std::vector<PriorityQueue<int>::Handle> handles;
+  std::vector<int> values;
+  for (int i = 0; i < 1000; ++i) {
+    int val = static_cast<int>(rng() % 10000);
+    handles.push_back(heap.push(val));
+    values.push_back(val);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    values[i] = static_cast<int>(rng() % 10000);
+    heap.update(handles[i], values[i]);
+  }
+  for (int i = 1; i < 1000; i += 7) {
+    heap.erase(handles[i]);
+    EXPECT_FALSE(heap.contains(handles[i]));
+    values[i] = -1;
+  }
+  for (int i = 0; i < 1000; ++i) {
+    if (values[i] >= 0) {
+      ASSERT_TRUE(heap.contains(handles[i]));
+      EXPECT_EQ(heap.get(handles[i]), values[i]);
+    }
+  }
+  std::vector<int> remaining;
+  for (int val : values) {
+    if (val >= 0) {
+      remaining.push_back(val);
+    }
+  }
+  std::sort(remaining.rbegin(), remaining.rend());
+  for (int val : remaining) {
+    ASSERT_EQ(heap.top(), val);
+    heap.pop();
+  }
+}
+
+TEST(PriorityQueueTest, PushPopKeepsTopHandle) {
+  PriorityQueue<int> heap;
+  auto low = heap.push(1);
+  auto high = heap.push(10);
+  EXPECT_EQ(heap.topHandle(), high);
+
+  //val would be the new top: returned without touching the heap
+  EXPECT_EQ(heap.pushPop(20), 20);
+  EXPECT_EQ(heap.get(high), 10);
+
+  //the popped top's handle now refers to the pushed value
+  EXPECT_EQ(heap.pushPop(5), 10);
+  ASSERT_TRUE(heap.contains(high));
+  EXPECT_EQ(heap.get(high), 5);
+  EXPECT_EQ(heap.get(low), 1);
+  EXPECT_EQ(heap.size(), 2u);
+
+  auto top = heap.topHandle();
+  EXPECT_EQ(heap.replaceTop(0), top);
+  EXPECT_EQ(heap.get(top), 0);
+  EXPECT_EQ(heap.top(), 1);
+}
+
+TEST(PriorityQueueTest, Heapify) {
+  Vector<int> values;
+  for (int i = 0; i < 100; ++i) {
+    values.pushBack((i * 37) % 100);
+  }
+  PriorityQueue<int> heap;
+  heap.heapify(std::move(values));
+  for (int i = 99; i >= 0; --i) {
+    ASSERT_EQ(heap.top(), i);
+    heap.pop();
+  }
+}
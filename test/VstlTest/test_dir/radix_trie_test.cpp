@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vstl/radix_trie.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+StringView view(const std::string& str) {
+  return StringView(str.data(), str.size());
+}
+
+//alphabet sizes that fill nodes of every kind: 4, 16, 48 and 256 children
+std::string randomKey(std::mt19937& rng, int alphabet) {
+  std::string key(rng() % 7, '\0');
+  for (char& ch : key) {
+    ch = static_cast<char>(alphabet == 256 ? rng() % 256 : 'a' + rng() % alphabet);
+  }
+  return key;
+}
+
+std::vector<std::pair<std::string, int>> walk(const RadixTrie<int>& trie, const std::string& prefix) {
+  std::vector<std::pair<std::string, int>> entries;
+  trie.forEachWithPrefix(view(prefix), [&entries](const RadixTrie<int>::Entry& entry) {
+    entries.emplace_back(std::string(entry.key.data(), entry.key.size()), entry.value);
+  });
+  return entries;
+}
+
+std::vector<std::pair<std::string, int>> expectedWalk(const std::map<std::string, int>& map,
+                                                      const std::string& prefix) {
+  std::vector<std::pair<std::string, int>> entries;
+  for (auto it = map.lower_bound(prefix); it != map.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+       ++it) {
+    entries.push_back(*it);
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(RadixTrieTest, MatchesStdMap) {
+  for (int alphabet : {3, 12, 40, 256}) {
+    std::mt19937 rng(70 + alphabet);
+    RadixTrie<int> trie;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 5000; ++i) {
+      std::string key = randomKey(rng, alphabet);
+      if (rng() % 2 == 0) {
+        EXPECT_EQ(trie.insert(view(key), i), expected.emplace(key, i).second);
+      } else {
+        trie.insertOrAssign(view(key), i);
+        expected[key] = i;
+      }
+    }
+    ASSERT_EQ(trie.size(), expected.size()) << alphabet;
+    for (int i = 0; i < 2000; ++i) {
+      std::string key = randomKey(rng, alphabet);
+      const int* found = trie.find(view(key));
+      auto it = expected.find(key);
+      ASSERT_EQ(found != nullptr, it != expected.end()) << alphabet;
+      if (found != nullptr) {
+        ASSERT_EQ(*found, it->second);
+      }
+    }
+    EXPECT_EQ(walk(trie, ""), expectedWalk(expected, "")) << alphabet;
+  }
+}
+
+TEST(RadixTrieTest, PrefixWalksMatchStdMap) {
+  std::mt19937 rng(80);
+  RadixTrie<int> trie;
+  std::map<std::string, int> expected;
+  for (int i = 0; i < 3000; ++i) {
+    std::string key = randomKey(rng, 5);
+    trie.insertOrAssign(view(key), i);
+    expected[key] = i;
+  }
+  for (int i = 0; i < 300; ++i) {
+    std::string prefix = randomKey(rng, 5).substr(0, rng() % 4);
+    ASSERT_EQ(walk(trie, prefix), expectedWalk(expected, prefix)) << prefix;
+  }
+}
+
+TEST(RadixTrieTest, LongestPrefix) {
+  RadixTrie<int> trie;
+  trie.insert("/", 0);
+  trie.insert("/api", 1);
+  trie.insert("/api/v1", 2);
+  trie.insert("/static", 3);
+  EXPECT_EQ(trie.longestPrefix("/api/v1/users")->value, 2);
+  EXPECT_EQ(trie.longestPrefix("/api/v2")->value, 1);
+  EXPECT_EQ(trie.longestPrefix("/ap")->value, 0);
+  EXPECT_EQ(trie.longestPrefix("/static")->value, 3);
+  EXPECT_EQ(trie.longestPrefix("none"), nullptr);
+
+  std::mt19937 rng(81);
+  RadixTrie<int> random_trie;
+  std::map<std::string, int> expected;
+  for (int i = 0; i < 2000; ++i) {
+    std::string key = randomKey(rng, 3);
+    random_trie.insertOrAssign(view(key), i);
+    expected[key] = i;
+  }
+  for (int i = 0; i < 1000; ++i) {
+    std::string query = randomKey(rng, 3) + randomKey(rng, 3);
+    const std::pair<const std::string, int>* best = nullptr;
+    for (size_t len = 0; len <= query.size(); ++len) {
+      auto it = expected.find(query.substr(0, len));
+      if (it != expected.end()) {
+        best = &*it;
+      }
+    }
+    const RadixTrie<int>::Entry* found = random_trie.longestPrefix(view(query));
+    ASSERT_EQ(found != nullptr, best != nullptr);
+    if (found != nullptr) {
+      EXPECT_EQ(std::string(found->key.data(), found->key.size()), best->first);
+      EXPECT_EQ(found->value, best->second);
+    }
+  }
+}
+
+TEST(RadixTrieTest, ClearAndMove) {
+  RadixTrie<int> trie;
+  trie.insert("alpha", 1);
+  trie.insert("alphabet", 2);
+  RadixTrie<int> moved(std::move(trie));
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(*moved.find("alphabet"), 2);
+  EXPECT_EQ(moved.find("alph"), nullptr);
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(moved.find("alpha"), nullptr);
+  moved.insert("again", 3);
+  EXPECT_EQ(*moved.find("again"), 3);
+}
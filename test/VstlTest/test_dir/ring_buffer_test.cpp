@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "vstl/ring_buffer.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(RingBufferTest, MatchesDeque) {
+  std::mt19937 rng(4);
+  RingBuffer<String> ring;
+  std::deque<String> expected;
+  for (int i = 0; i < 20000; ++i) {
+    String val("value that is long enough to be heap allocated ");
+    val.appendInt(i);
+    switch (rng() % 5) {
+      case 0:
+        ring.pushFront(val);
+        expected.push_front(val);
+        break;
+      case 1:
+      case 2:
+        ring.pushBack(val);
+        expected.push_back(val);
+        break;
+      case 3:
+        if (!expected.empty()) {
+          EXPECT_EQ(ring.front(), expected.front());
+          ring.popFront();
+          expected.pop_front();
+        }
+        break;
+      default:
+        if (!expected.empty()) {
+          EXPECT_EQ(ring.back(), expected.back());
+          ring.popBack();
+          expected.pop_back();
+        }
+    }
+    ASSERT_EQ(ring.size(), expected.size());
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(ring[i], expected[i]);
+  }
+}
+
+TEST(RingBufferTest, BulkPushAndPopAcrossTheSeam) {
+  RingBuffer<int> ring(8);
+  std::vector<int> src = {1, 2, 3, 4, 5, 6};
+  ring.pushN(src.data(), src.size());
+  std::vector<int> out(4);
+  EXPECT_EQ(ring.popN(out.data(), 4), 4u);
+  EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4}));
+
+  //wraps around the end of the storage
+  ring.pushN(src.data(), src.size());
+  EXPECT_EQ(ring.size(), 8u);
+  out.resize(10);
+  EXPECT_EQ(ring.popN(out.data(), 10), 8u);
+  out.resize(8);
+  EXPECT_EQ(out, (std::vector<int>{5, 6, 1, 2, 3, 4, 5, 6}));
+  EXPECT_TRUE(ring.empty());
+
+  //grows when not in overwrite mode
+  std::vector<int> many(100, 7);
+  ring.pushN(many.data(), many.size());
+  EXPECT_EQ(ring.size(), 100u);
+  EXPECT_GE(ring.capacity(), 100u);
+}
+
+TEST(RingBufferTest, OverwriteOldest) {
+  RingBuffer<int> ring(4, true);
+  for (int i = 0; i < 10; ++i) {
+    ring.pushBack(i);
+  }
+  ASSERT_EQ(ring.size(), 4u);
+  EXPECT_EQ(ring.capacity(), 4u);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(ring[i], static_cast<int>(6 + i));
+  }
+
+  //a full buffer drops its newest element on pushFront
+  ring.pushFront(100);
+  EXPECT_EQ(ring.front(), 100);
+  EXPECT_EQ(ring.back(), 8);
+
+  std::vector<int> src = {1, 2, 3, 4, 5, 6};
+  ring.pushN(src.data(), src.size());
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(ring[i], static_cast<int>(3 + i));
+  }
+}
+
+TEST(RingBufferTest, StaticStorage) {
+  RingBuffer<int, 4, StaticMemory> ring;
+  for (int i = 0; i < 4; ++i) {
+    ring.pushBack(i);
+  }
+  EXPECT_TRUE(ring.full());
+  EXPECT_THROW(ring.pushBack(4), std::overflow_error);
+}
+
+TEST(RingBufferTest, PushElementsOfItself) {
+  RingBuffer<String> ring(4);
+  for (int i = 0; i < 4; ++i) {
+    ring.pushBack(String(30, static_cast<char>('a' + i)));
+  }
+  ring.pushBack(ring.front());
+  ring.pushFront(ring.back());
+  ASSERT_EQ(ring.size(), 6u);
+  EXPECT_EQ(ring.front(), String(30, 'a'));
+  EXPECT_EQ(ring.back(), String(30, 'a'));
+
+  ring.pushN(&ring[1], 2);
+  ASSERT_EQ(ring.size(), 8u);
+  //full, so this grows; ring[1] .. ring[4] sit in one span
+  ring.pushN(&ring[1], 4);
+  ASSERT_EQ(ring.size(), 12u);
+  EXPECT_EQ(ring[8], String(30, 'a'));
+  EXPECT_EQ(ring[10], String(30, 'c'));
+
+  RingBuffer<String> overwriting(4, true);
+  for (int i = 0; i < 4; ++i) {
+    overwriting.pushBack(String(30, static_cast<char>('a' + i)));
+  }
+  overwriting.pushN(&overwriting[0], 3);
+  EXPECT_EQ(overwriting[0], String(30, 'd'));
+  EXPECT_EQ(overwriting[1], String(30, 'a'));
+  EXPECT_EQ(overwriting[3], String(30, 'c'));
+}
+
+TEST(RingBufferTest, MoveElementsOfItself) {
+  RingBuffer<String> ring(2);
+  ring.pushBack(String(30, 'a'));
+  ring.pushBack(String(30, 'b'));
+  ring.pushBack(std::move(ring.front()));
+  ASSERT_EQ(ring.size(), 3u);
+  EXPECT_EQ(ring.back(), String(30, 'a'));
+  ring.pushBack(String(30, 'c'));
+  ring.pushFront(std::move(ring.back()));
+  ASSERT_EQ(ring.size(), 5u);
+  EXPECT_EQ(ring.front(), String(30, 'c'));
+  EXPECT_EQ(ring[2], String(30, 'b'));
+}
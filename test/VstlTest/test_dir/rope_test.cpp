@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "vstl/rope.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::string toStd(const Rope& rope) {
+  String flat = rope.flatten();
+  return std::string(flat.data(), flat.size());
+}
+
+std::string joinedSpans(const Rope& rope) {
+  std::string result;
+  Vector<StringView> spans = rope.spans();
+  for (size_t i = 0; i < spans.size(); ++i) {
+    result.append(spans.data()[i].data(), spans.data()[i].size());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(RopeTest, EmptyRope) {
+  Rope rope;
+  EXPECT_TRUE(rope.empty());
+  EXPECT_EQ(rope.depth(), 0);
+  EXPECT_EQ(toStd(rope), "");
+  EXPECT_THROW(rope[0], std::out_of_range);
+  EXPECT_TRUE(rope.substr(0).empty());
+  EXPECT_THROW(rope.substr(1), std::out_of_range);
+}
+
+TEST(RopeTest, IndexPastTheEndThrows) {
+  Rope rope(StringView("abc"));
+  EXPECT_EQ(rope[2], 'c');
+  EXPECT_THROW(rope[3], std::out_of_range);
+}
+
+TEST(RopeTest, MatchesStdString) {
+  std::mt19937 rng(21);
+  Rope rope;
+  std::string expected;
+  for (int i = 0; i < 2000; ++i) {
+    std::string piece(1 + rng() % 400, static_cast<char>('a' + i % 26));
+    if (rng() % 3 == 0) {
+      rope.prepend(StringView(piece.c_str()));
+      expected.insert(0, piece);
+    } else if (rng() % 2 == 0) {
+      rope.append(String(piece.c_str()));
+      expected += piece;
+    } else {
+      rope += StringView(piece.c_str());
+      expected += piece;
+    }
+  }
+  ASSERT_EQ(rope.size(), expected.size());
+  EXPECT_EQ(toStd(rope), expected);
+  EXPECT_EQ(joinedSpans(rope), expected);
+  for (int i = 0; i < 500; ++i) {
+    size_t idx = rng() % expected.size();
+    ASSERT_EQ(rope[idx], expected[idx]);
+  }
+  //balanced: depth stays logarithmic in the number of leaves
+  EXPECT_LT(rope.depth(), 40);
+}
+
+TEST(RopeTest, SubstrSharesAndClamps) {
+  std::mt19937 rng(22);
+  Rope rope;
+  std::string expected;
+  for (int i = 0; i < 300; ++i) {
+    std::string piece(1 + rng() % 300, static_cast<char>('A' + i % 26));
+    rope.append(StringView(piece.c_str()));
+    expected += piece;
+  }
+  for (int i = 0; i < 200; ++i) {
+    size_t pos = rng() % (expected.size() + 1);
+    size_t count = rng() % 2000;
+    Rope part = rope.substr(pos, count);
+    ASSERT_EQ(toStd(part), expected.substr(pos, count)) << pos << " " << count;
+  }
+  EXPECT_EQ(toStd(rope.substr(10)), expected.substr(10));
+}
+
+TEST(RopeTest, CopiesAreIndependent) {
+  Rope rope(StringView("base"));
+  Rope copy = rope;
+  copy.append(StringView(" more"));
+  rope.prepend(StringView("the "));
+  EXPECT_EQ(toStd(rope), "the base");
+  EXPECT_EQ(toStd(copy), "base more");
+}
+
+TEST(RopeTest, SmallAppendsGrowTheLastLeaf) {
+  Rope rope(String(std::string(1000, 'x').c_str()));
+  rope.prepend(String(std::string(1000, 'y').c_str()));
+  std::string expected = std::string(1000, 'y') + std::string(1000, 'x');
+  for (int i = 0; i < 500; ++i) {
+    rope.append(StringView("ab"));
+    rope.prepend(StringView("c"));
+    expected += "ab";
+    expected.insert(0, "c");
+  }
+  EXPECT_EQ(toStd(rope), expected);
+  //1000 appended chars fit in 4 leaves of merge_limit, 500 prepended in 2
+  EXPECT_LE(rope.spans().size(), 2u + 4u + 2u);
+  EXPECT_LE(rope.depth(), 4);
+}
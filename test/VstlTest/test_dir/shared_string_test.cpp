@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vstl/shared_string.hpp"
+
+using namespace stdvector;
+
+TEST(SharedStringTest, EmptyHasNoBuffer) {
+  SharedString str;
+  EXPECT_TRUE(str.empty());
+  EXPECT_EQ(str.useCount(), 0u);
+  EXPECT_STREQ(str.c_str(), "");
+  EXPECT_EQ(str.mutableData(), nullptr);
+  SharedString from_empty("");
+  EXPECT_EQ(from_empty.useCount(), 0u);
+}
+
+TEST(SharedStringTest, CopiesShareOneBuffer) {
+  SharedString str("shared contents");
+  SharedString copy = str;
+  SharedString another(copy);
+  EXPECT_EQ(str.data(), copy.data());
+  EXPECT_EQ(str.useCount(), 3u);
+  copy.clear();
+  EXPECT_EQ(str.useCount(), 2u);
+  SharedString moved(std::move(another));
+  EXPECT_EQ(another.useCount(), 0u);
+  EXPECT_EQ(moved.data(), str.data());
+  EXPECT_EQ(str.useCount(), 2u);
+}
+
+TEST(SharedStringTest, MutationDetachesSharedBuffer) {
+  SharedString str("base");
+  SharedString copy = str;
+  copy += "-more";
+  EXPECT_EQ(StringView(str), StringView("base"));
+  EXPECT_EQ(StringView(copy), StringView("base-more"));
+  EXPECT_NE(str.data(), copy.data());
+  EXPECT_EQ(str.useCount(), 1u);
+  EXPECT_EQ(copy.useCount(), 1u);
+
+  SharedString other = str;
+  other.mutableData()[0] = 'c';
+  EXPECT_EQ(StringView(str), StringView("base"));
+  EXPECT_EQ(StringView(other), StringView("case"));
+}
+
+TEST(SharedStringTest, SoleOwnerChangesInPlace) {
+  SharedString str("abc");
+  str += "defghijklmnop";
+  size_t capacity = str.capacity();
+  const char* buffer = str.data();
+  while (str.size() < capacity) {
+    str.push_back('x');
+  }
+  EXPECT_EQ(str.data(), buffer);
+  EXPECT_EQ(str.mutableData(), buffer);
+  str.push_back('y');
+  EXPECT_GE(str.capacity(), 2 * capacity);
+  EXPECT_EQ(str[str.size() - 1], 'y');
+}
+
+TEST(SharedStringTest, AppendFromItself) {
+  SharedString str("abcd");
+  str += StringView(str);
+  EXPECT_EQ(StringView(str), StringView("abcdabcd"));
+  SharedString copy = str;
+  str += StringView(str).substr(2, 3);
+  EXPECT_EQ(StringView(str), StringView("abcdabcdcda"));
+  EXPECT_EQ(StringView(copy), StringView("abcdabcd"));
+}
+
+TEST(SharedStringTest, HashesLikeString) {
+  SharedString str("hash me");
+  EXPECT_EQ(Hash<SharedString>()(str), Hash<String>()(String("hash me")));
+  EXPECT_EQ(Hash<SharedString>()(str), Hash<SharedString>()(StringView("hash me")));
+  EXPECT_EQ(str.str(), String("hash me"));
+}
+
+TEST(SharedStringTest, ThreadsCopyAndDetach) {
+  SharedString original("a value shared between threads");
+  std::vector<std::thread> threads;
+  std::vector<char> ok(4, 1);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&original, &ok, t] {
+      for (int i = 0; i < 10000; ++i) {
+        SharedString copy = original;
+        if (i % 10 == 0) {
+          copy += 'x';
+          ok[t] = ok[t] && copy.size() == original.size() + 1;
+        }
+        ok[t] = ok[t] && copy[0] == 'a';
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (char thread_ok : ok) {
+    EXPECT_TRUE(thread_ok);
+  }
+  EXPECT_EQ(original.useCount(), 1u);
+  EXPECT_EQ(StringView(original), StringView("a value shared between threads"));
+}
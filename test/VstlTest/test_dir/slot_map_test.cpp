@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "vstl/slot_map.hpp"
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+TEST(SlotMapTest, RandomInsertEraseMatchesReference) {
+  using Map = SlotMap<int>;
+  std::mt19937 rng(8);
+  Map map;
+  std::vector<std::pair<Map::Handle, int>> live;
+  std::vector<Map::Handle> dead;
+  for (int i = 0; i < 20000; ++i) {
+    if (live.empty() || rng() % 3 != 0) {
+      int val = static_cast<int>(rng());
+      live.emplace_back(map.insert(val), val);
+    } else {
+      size_t pick = rng() % live.size();
+      EXPECT_TRUE(map.erase(live[pick].first));
+      dead.push_back(live[pick].first);
+      live[pick] = live.back();
+      live.pop_back();
+    }
+  }
+  ASSERT_EQ(map.size(), live.size());
+  for (const auto& item : live) {
+    const int* val = map.get(item.first);
+    ASSERT_NE(val, nullptr);
+    EXPECT_EQ(*val, item.second);
+  }
+  for (const auto& handle : dead) {
+    EXPECT_FALSE(map.contains(handle));
+    EXPECT_EQ(map.get(handle), nullptr);
+    EXPECT_FALSE(map.erase(handle));
+  }
+}
+
+TEST(SlotMapTest, ReusedSlotRejectsStaleHandle) {
+  SlotMap<String> map;
+  auto first = map.insert(String("first"));
+  EXPECT_TRUE(map.erase(first));
+  auto second = map.insert(String("second"));
+  EXPECT_EQ(second.index, first.index);
+  EXPECT_NE(second, first);
+  EXPECT_EQ(map.get(first), nullptr);
+  EXPECT_EQ(*map.get(second), String("second"));
+}
+
+TEST(SlotMapTest, FreeSlotRejectsForgedHandle) {
+  SlotMap<int> map;
+  auto first = map.insert(1);
+  auto second = map.insert(2);
+  EXPECT_TRUE(map.erase(first));
+  EXPECT_TRUE(map.erase(second));
+  for (uint32_t bump = 0; bump < 4; ++bump) {
+    SlotMap<int>::Handle forged{first.index, first.generation + bump};
+    EXPECT_FALSE(map.contains(forged));
+    EXPECT_EQ(map.get(forged), nullptr);
+    EXPECT_FALSE(map.erase(forged));
+  }
+  map.clear();
+  EXPECT_FALSE(map.contains(SlotMap<int>::Handle{second.index, second.generation + 1}));
+  EXPECT_FALSE(map.contains(SlotMap<int>::Handle{0, 0}));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(SlotMapTest, DenseIterationAndHandleAt) {
+  SlotMap<int> map;
+  std::vector<SlotMap<int>::Handle> handles;
+  for (int i = 0; i < 10; ++i) {
+    handles.push_back(map.insert(i));
+  }
+  map.erase(handles[3]);
+  int sum = 0;
+  size_t idx = 0;
+  for (int val : map) {
+    sum += val;
+    EXPECT_EQ(*map.get(map.handleAt(idx)), val);
+    ++idx;
+  }
+  EXPECT_EQ(sum, 45 - 3);
+  EXPECT_EQ(idx, 9u);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  for (const auto& handle : handles) {
+    EXPECT_FALSE(map.contains(handle));
+  }
+}
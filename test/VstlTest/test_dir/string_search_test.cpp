@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vstl/string_search.hpp"
+#include "vstl/string_view.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+//lengths around the 16 and 32 byte blocks of the vector paths
+const size_t lengths[] = {0, 1, 7, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 100, 129};
+
+int sign(int val) {
+  return (val > 0) - (val < 0);
+}
+
+std::string randomText(std::mt19937& rng, size_t len, int alphabet) {
+  std::string text(len, 'a');
+  for (char& ch : text) {
+    ch = static_cast<char>('a' + rng() % alphabet);
+  }
+  return text;
+}
+
+}  // namespace
+
+TEST(StringSearchTest, FindByteEveryPosition) {
+  for (size_t len : lengths) {
+    std::vector<char> data(len, 'x');
+    for (size_t at = 0; at < len; ++at) {
+      data[at] = 'y';
+      for (size_t pos = 0; pos <= len; ++pos) {
+        EXPECT_EQ(findByte(data.data(), len, 'y', pos), pos <= at ? at : search_npos) << len << " " << at;
+      }
+      data[at] = 'x';
+    }
+    EXPECT_EQ(findByte(data.data(), len, 'y'), search_npos);
+  }
+}
+
+TEST(StringSearchTest, FindByteHighBytes) {
+  std::string data(70, '\x7f');
+  data[50] = '\x80';
+  data[60] = '\xff';
+  EXPECT_EQ(findByte(data.data(), data.size(), '\x80'), 50u);
+  EXPECT_EQ(findByte(data.data(), data.size(), '\xff'), 60u);
+}
+
+TEST(StringSearchTest, FindBytesMatchesStdString) {
+  std::mt19937 rng(5);
+  for (int round = 0; round < 2000; ++round) {
+    std::string text = randomText(rng, lengths[rng() % 15], 2 + rng() % 3);
+    std::string needle = randomText(rng, rng() % 6, 2 + rng() % 3);
+    size_t pos = rng() % (text.size() + 2);
+    size_t expected = pos > text.size() ? std::string::npos : text.find(needle, pos);
+    EXPECT_EQ(findBytes(text.data(), text.size(), needle.data(), needle.size(), pos), expected)
+        << text << " " << needle << " " << pos;
+  }
+}
+
+TEST(StringSearchTest, PositionsNearNposFindNothing) {
+  for (size_t len : lengths) {
+    std::string text(len, 'x');
+    text += "xy";
+    const char* data = text.data();
+    for (size_t pos : {search_npos, search_npos - 1, search_npos - 5, search_npos - 40, text.size(),
+                       text.size() + 1}) {
+      EXPECT_EQ(findByte(data, text.size(), 'x', pos), search_npos) << len << " " << pos;
+      EXPECT_EQ(findBytes(data, text.size(), "xy", 2, pos), search_npos) << len << " " << pos;
+      EXPECT_EQ(findBytes(data, text.size(), "", 0, pos), pos == text.size() ? pos : search_npos);
+      EXPECT_EQ(findFirstOf(data, text.size(), CharSet("xy", 2), pos), search_npos) << len << " " << pos;
+    }
+    EXPECT_EQ(findBytes(data, text.size(), "xy", 2, text.size() - 2), len);
+  }
+  std::string text(46, 'x');
+  StringView view(text.data(), text.size());
+  EXPECT_EQ(view.find('x', StringView::npos), StringView::npos);
+  EXPECT_EQ(view.find("xy", StringView::npos - 5), StringView::npos);
+  EXPECT_EQ(view.findFirstOf("x", StringView::npos), StringView::npos);
+}
+
+TEST(StringSearchTest, FindFirstOfMatchesStdString) {
+  std::mt19937 rng(6);
+  for (int round = 0; round < 2000; ++round) {
+    std::string text = randomText(rng, lengths[rng() % 15], 8);
+    std::string chars = randomText(rng, rng() % 3, 10);
+    if (rng() % 4 == 0) {
+      chars += '\xe9';
+      text += '\xe9';
+    }
+    size_t pos = rng() % (text.size() + 1);
+    EXPECT_EQ(findFirstOf(text.data(), text.size(), CharSet(chars.data(), chars.size()), pos),
+              text.find_first_of(chars, pos));
+  }
+}
+
+TEST(StringSearchTest, CharSetContains) {
+  const char chars[] = {'\0', 'a', '\x7f', '\x80', '\xff'};
+  CharSet set(chars, sizeof(chars));
+  for (int byte = 0; byte < 256; ++byte) {
+    char ch = static_cast<char>(byte);
+    EXPECT_EQ(set.contains(ch), std::memchr(chars, ch, sizeof(chars)) != nullptr) << byte;
+  }
+}
+
+TEST(StringSearchTest, CountByte) {
+  std::mt19937 rng(7);
+  for (size_t len : lengths) {
+    std::string text = randomText(rng, len, 3);
+    size_t expected = 0;
+    for (char ch : text) {
+      expected += ch == 'b';
+    }
+    EXPECT_EQ(countByte(text.data(), text.size(), 'b'), expected);
+  }
+}
+
+TEST(StringSearchTest, CompareAndEqualAsUnsignedBytes) {
+  std::mt19937 rng(8);
+  for (size_t len : lengths) {
+    std::string lhs = randomText(rng, len, 3);
+    for (size_t at = 0; at < len; ++at) {
+      std::string rhs = lhs;
+      rhs[at] = '\xf0';
+      EXPECT_LT(compareBytes(lhs.data(), rhs.data(), len), 0);
+      EXPECT_GT(compareBytes(rhs.data(), lhs.data(), len), 0);
+      EXPECT_EQ(sign(compareBytes(lhs.data(), rhs.data(), len)), sign(std::memcmp(lhs.data(), rhs.data(), len)));
+      EXPECT_FALSE(equalBytes(lhs.data(), rhs.data(), len));
+    }
+    EXPECT_EQ(compareBytes(lhs.data(), lhs.data(), len), 0);
+    EXPECT_TRUE(equalBytes(lhs.data(), std::string(lhs).data(), len));
+  }
+}
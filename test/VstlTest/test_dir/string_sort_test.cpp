@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vstl/string_sort.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+//short random tails behind a shared prefix, so groups run several words deep
+std::vector<std::string> randomKeys(std::mt19937& rng, size_t count, size_t prefix_len) {
+  std::string prefix(prefix_len, 'p');
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < count; ++i) {
+    std::string key = rng() % 8 == 0 ? std::string() : prefix;
+    size_t tail = rng() % 6;
+    for (size_t k = 0; k < tail; ++k) {
+      key.push_back(static_cast<char>(rng() % 3 == 0 ? '\xe0' + rng() % 4 : 'a' + rng() % 3));
+    }
+    if (rng() % 16 == 0) {
+      key.push_back('\0');
+    }
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+//sorts the keys as Strings and as views, checks both against std::stable_sort
+void expectSortedLikeStd(const std::vector<std::string>& keys, size_t threads) {
+  std::vector<std::string> expected = keys;
+  std::stable_sort(expected.begin(), expected.end());
+
+  Vector<String> strings;
+  Vector<StringView> views;
+  for (const std::string& key : keys) {
+    strings.pushBack(String(StringView(key.data(), key.size())));
+    views.pushBack(StringView(key.data(), key.size()));
+  }
+  sortStrings(strings, threads);
+  sortStrings(views, threads);
+  ASSERT_EQ(strings.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    StringView want(expected[i].data(), expected[i].size());
+    ASSERT_EQ(StringView(strings.data()[i]), want) << i;
+    ASSERT_EQ(views.data()[i], want) << i;
+  }
+}
+
+}  // namespace
+
+TEST(StringSortTest, MatchesStdSortAtEveryPrefixLength) {
+  std::mt19937 rng(61);
+  for (size_t prefix_len : {0, 3, 7, 8, 9, 16, 20}) {
+    expectSortedLikeStd(randomKeys(rng, 3000, prefix_len), 1);
+  }
+}
+
+TEST(StringSortTest, SmallInputs) {
+  expectSortedLikeStd({}, 1);
+  expectSortedLikeStd({"only"}, 1);
+  expectSortedLikeStd({"b", "a", "", "ab", "a"}, 1);
+}
+
+TEST(StringSortTest, OrderIsStable) {
+  std::mt19937 rng(62);
+  std::vector<std::string> keys = randomKeys(rng, 5000, 10);
+  std::vector<uint32_t> expected(keys.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = static_cast<uint32_t>(i);
+  }
+  std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t lhs, uint32_t rhs) {
+    return keys[lhs] < keys[rhs];
+  });
+  Vector<uint32_t> order = sortedStringOrder(keys.size(), [&keys](size_t i) {
+    return StringView(keys[i].data(), keys[i].size());
+  });
+  ASSERT_EQ(order.size(), expected.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), order.data()));
+}
+
+TEST(StringSortTest, ParallelBucketsMatchStdSort) {
+  std::mt19937 rng(63);
+  std::vector<std::string> keys = randomKeys(rng, 100000, 1);
+  expectSortedLikeStd(keys, 4);
+  expectSortedLikeStd(keys, 0);
+}
+
+TEST(StringSortTest, DegenerateInputs) {
+  //already sorted, reversed and all equal inputs of long keys
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; ++i) {
+    keys.push_back(std::string(40, 'k') + std::to_string(100000 + i));
+  }
+  expectSortedLikeStd(keys, 1);
+  std::reverse(keys.begin(), keys.end());
+  expectSortedLikeStd(keys, 1);
+  expectSortedLikeStd(std::vector<std::string>(20000, std::string(100, 'e')), 1);
+}
+
+TEST(StringSortTest, RefusesWhatDoesNotFitThirtyTwoBits) {
+  const char text[] = "abc";
+  auto small = [&text](size_t) { return StringView(text, 3); };
+  EXPECT_THROW(sortedStringOrder(size_t(UINT32_MAX) + 1, small), std::length_error);
+  auto huge = [&text](size_t i) { return StringView(text, i == 1 ? size_t(UINT32_MAX) + 1 : 3); };
+  EXPECT_THROW(sortedStringOrder(2, huge), std::length_error);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vstl/string_table.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::vector<std::string> values(const StringTable& table) {
+  std::vector<std::string> result;
+  for (size_t i = 0; i < table.size(); ++i) {
+    result.emplace_back(table[i].data(), table[i].size());
+  }
+  return result;
+}
+
+std::vector<std::string> randomWords(std::mt19937& rng, size_t count) {
+  std::vector<std::string> words;
+  for (size_t i = 0; i < count; ++i) {
+    std::string word(rng() % 12, 'a');
+    for (char& ch : word) {
+      ch = static_cast<char>('a' + rng() % 4);
+    }
+    words.push_back(word);
+  }
+  return words;
+}
+
+}  // namespace
+
+TEST(StringTableTest, AppendAndIndex) {
+  StringTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.append("first"), 0u);
+  EXPECT_EQ(table.append(""), 1u);
+  EXPECT_EQ(table.append("third value"), 2u);
+  EXPECT_EQ(values(table), (std::vector<std::string>{"first", "", "third value"}));
+  EXPECT_EQ(table.bytes(), 16u);
+  StringTable copy = table;
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(values(copy), (std::vector<std::string>{"first", "", "third value"}));
+}
+
+TEST(StringTableTest, AppendDelimited) {
+  StringTable table;
+  table.append("before");
+  EXPECT_EQ(table.appendDelimited("a\n\nb\n"), 3u);
+  EXPECT_EQ(table.appendDelimited("c,d", ','), 2u);
+  EXPECT_EQ(table.appendDelimited(""), 0u);
+  EXPECT_EQ(values(table), (std::vector<std::string>{"before", "a", "", "b", "c", "d"}));
+  EXPECT_EQ(table.bytes(), 10u);
+}
+
+TEST(StringTableTest, AppendEntriesOfItself) {
+  std::mt19937 rng(50);
+  StringTable table;
+  std::vector<std::string> expected;
+  table.append("seed value");
+  expected.push_back("seed value");
+  for (int i = 0; i < 500; ++i) {
+    size_t idx = rng() % table.size();
+    table.append(table[idx]);
+    expected.push_back(expected[idx]);
+  }
+  ASSERT_EQ(values(table), expected);
+
+  StringTable fields;
+  fields.append("a,bc");
+  fields.append(",d");
+  //one view over every character stored so far
+  EXPECT_EQ(fields.appendDelimited(StringView(fields[0].data(), fields.bytes()), ','), 3u);
+  EXPECT_EQ(values(fields), (std::vector<std::string>{"a,bc", ",d", "a", "bc", "d"}));
+}
+
+TEST(StringTableTest, LoadDelimited) {
+  std::string path = testing::TempDir() + "string_table_test_lines.txt";
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  std::string contents;
+  for (int i = 0; i < 50000; ++i) {
+    contents += "line " + std::to_string(i) + "\n";
+  }
+  std::fwrite(contents.data(), 1, contents.size(), file);
+  std::fclose(file);
+
+  StringTable table;
+  EXPECT_EQ(table.loadDelimited(path.c_str()), 50000u);
+  std::remove(path.c_str());
+  EXPECT_EQ(std::string(table[0].data(), table[0].size()), "line 0");
+  EXPECT_EQ(std::string(table[49999].data(), table[49999].size()), "line 49999");
+  EXPECT_THROW(table.loadDelimited(path.c_str()), std::runtime_error);
+}
+
+TEST(StringTableTest, SortedIndicesAreStable) {
+  std::mt19937 rng(51);
+  std::vector<std::string> words = randomWords(rng, 5000);
+  StringTable table;
+  for (const std::string& word : words) {
+    table.append(StringView(word.data(), word.size()));
+  }
+  std::vector<uint32_t> expected(words.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = static_cast<uint32_t>(i);
+  }
+  std::stable_sort(expected.begin(), expected.end(), [&words](uint32_t lhs, uint32_t rhs) {
+    return words[lhs] < words[rhs];
+  });
+  for (size_t threads : {1, 4}) {
+    Vector<uint32_t> order = table.sortedIndices(threads);
+    ASSERT_EQ(order.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), order.data())) << threads;
+  }
+  table.sort(2);
+  std::sort(words.begin(), words.end());
+  EXPECT_EQ(values(table), words);
+}
+
+TEST(DictStringTableTest, EncodeDecode) {
+  std::mt19937 rng(52);
+  std::vector<std::string> words = randomWords(rng, 3000);
+  StringTable table;
+  for (const std::string& word : words) {
+    table.append(StringView(word.data(), word.size()));
+  }
+  DictStringTable dict = DictStringTable::encode(table);
+  ASSERT_EQ(dict.size(), words.size());
+  std::vector<std::string> distinct = words;
+  std::sort(distinct.begin(), distinct.end());
+  distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+  EXPECT_EQ(dict.dictionarySize(), distinct.size());
+  for (size_t i = 0; i < words.size(); ++i) {
+    ASSERT_EQ(std::string(dict[i].data(), dict[i].size()), words[i]);
+    ASSERT_EQ(dict.value(dict.code(i)), dict[i]);
+  }
+  EXPECT_EQ(values(dict.decode()), words);
+}
+
+TEST(DictStringTableTest, EqualValuesShareACode) {
+  DictStringTable dict;
+  uint32_t red = dict.append("red");
+  uint32_t green = dict.append("green");
+  EXPECT_EQ(dict.append("red"), red);
+  EXPECT_NE(red, green);
+  EXPECT_EQ(dict.find("green"), green);
+  EXPECT_EQ(dict.find("blue"), DictStringTable::npos);
+  EXPECT_EQ(dict.size(), 3u);
+  EXPECT_EQ(dict.dictionarySize(), 2u);
+  EXPECT_EQ(dict.codes().size(), 3u);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "vstl/string.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+using Concat = StringConcat<StringPiece, StringPiece>;
+
+String passThrough(const String& str) {
+  return str;
+}
+
+}  // namespace
+
+static_assert(!std::is_copy_constructible<Concat>::value, "a chain must not be copied out of its expression");
+static_assert(!std::is_move_constructible<Concat>::value, "a chain must not be moved out of its expression");
+static_assert(std::is_constructible<String, Concat&&>::value, "a temporary chain converts to String");
+static_assert(!std::is_constructible<String, Concat&>::value, "a named chain does not convert to String");
+static_assert(!std::is_constructible<String, const Concat&>::value, "a named chain does not convert to String");
+
+TEST(StringConcatTest, MixedOperands) {
+  String a("alpha");
+  String b("a string that is too long for the inline buffer");
+  String s = a + "-" + b + StringView("-view") + String("-temp");
+  EXPECT_EQ(std::string(s.c_str()), std::string("alpha-") + b.c_str() + "-view-temp");
+  String t = "prefix " + a;
+  EXPECT_EQ(t, "prefix alpha");
+  EXPECT_EQ(std::string(passThrough(a + b).c_str()), std::string(a.c_str()) + b.c_str());
+}
+
+TEST(StringConcatTest, TemporaryLeftGrowsInPlace) {
+  String a("abc");
+  String s = String("start:") + a + ":" + (a + a);
+  EXPECT_EQ(s, "start:abc:abcabc");
+}
+
+TEST(StringConcatTest, AllocatesExactlyTheTotal) {
+  String a(40, 'a');
+  String b(40, 'b');
+  String s = a + b;
+  EXPECT_EQ(s.size(), 80u);
+  EXPECT_EQ(s.capacity(), 80u);
+}
+
+TEST(StringConcatTest, AppendChain) {
+  String s("x");
+  String a("yy");
+  s += a + "z" + a;
+  EXPECT_EQ(s, "xyyzyy");
+}
+
+TEST(StringConcatTest, ChainReadingItsTarget) {
+  String s("self");
+  s = s + s + s;
+  EXPECT_EQ(s, "selfselfself");
+  s += s + "!" + s;
+  EXPECT_EQ(s, "selfselfselfselfselfself!selfselfself");
+  String big(30, 'q');
+  big += "<" + big + ">";
+  EXPECT_EQ(std::string(big.c_str()), std::string(30, 'q') + "<" + std::string(30, 'q') + ">");
+}
+
+TEST(StringTest, ThreeWordsWithTwentyTwoInline) {
+  EXPECT_EQ(sizeof(String), 3 * sizeof(size_t));
+  String empty;
+  EXPECT_EQ(empty.size(), 0u);
+  EXPECT_EQ(empty.capacity(), 22u);
+  String inline_max(22, 'i');
+  EXPECT_EQ(inline_max.capacity(), 22u);
+  EXPECT_EQ(std::strlen(inline_max.c_str()), 22u);
+  const char* object = reinterpret_cast<const char*>(&inline_max);
+  EXPECT_TRUE(inline_max.data() >= object && inline_max.data() < object + sizeof(String));
+  String heap(23, 'h');
+  EXPECT_GE(heap.capacity(), 23u);
+  EXPECT_EQ(heap.c_str()[23], '\0');
+}
+
+TEST(StringTest, GrowsAcrossTheInlineLimit) {
+  String str;
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    str.push_back(static_cast<char>('a' + i % 26));
+    expected.push_back(static_cast<char>('a' + i % 26));
+    ASSERT_EQ(str.size(), expected.size());
+    ASSERT_EQ(std::string(str.c_str()), expected);
+  }
+  while (str.size() > 0) {
+    str.pop_back();
+    expected.pop_back();
+    ASSERT_EQ(std::string(str.c_str()), expected);
+  }
+}
+
+TEST(StringTest, SwapAndMoveEveryForm) {
+  const char* texts[] = {"", "short", "exactly twenty-two chr", "long enough that it has to live on the heap"};
+  for (const char* lhs_text : texts) {
+    for (const char* rhs_text : texts) {
+      String lhs(lhs_text);
+      String rhs(rhs_text);
+      lhs.swap(rhs);
+      EXPECT_EQ(lhs, rhs_text);
+      EXPECT_EQ(rhs, lhs_text);
+      String moved(std::move(lhs));
+      EXPECT_EQ(moved, rhs_text);
+      EXPECT_EQ(lhs.size(), 0u);
+      EXPECT_EQ(lhs, "");
+      rhs = std::move(moved);
+      EXPECT_EQ(rhs, rhs_text);
+    }
+  }
+}
+
+TEST(StringTest, CopyAssignReusesTheBuffer) {
+  String str(60, 'x');
+  const char* buffer = str.data();
+  String copy(50, 'z');
+  str = copy;
+  EXPECT_EQ(str, copy);
+  EXPECT_EQ(str.data(), buffer);
+  str = String("tiny");
+  EXPECT_EQ(str, "tiny");
+}
+
+TEST(StringTest, ResizeFillsAndTruncates) {
+  String str("ab");
+  str.resize(30, '-');
+  EXPECT_EQ(std::string(str.c_str()), "ab" + std::string(28, '-'));
+  str.resize(1);
+  EXPECT_EQ(str, "a");
+  EXPECT_EQ(str.c_str()[1], '\0');
+}
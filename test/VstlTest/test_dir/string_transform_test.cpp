@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <random>
+#include <string>
+
+#include "vstl/hash_map.hpp"
+#include "vstl/string_transform.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::string toStd(const String& str) {
+  return std::string(str.data(), str.size());
+}
+
+std::string randomBytes(std::mt19937& rng, size_t len) {
+  std::string text(len, '\0');
+  for (char& ch : text) {
+    ch = static_cast<char>(rng());
+  }
+  return text;
+}
+
+int sign(int val) {
+  return (val > 0) - (val < 0);
+}
+
+}  // namespace
+
+TEST(StringTransformTest, CaseMappingMatchesCtype) {
+  std::mt19937 rng(100);
+  for (size_t len = 0; len < 140; ++len) {
+    std::string text = randomBytes(rng, len);
+    std::string lower = text;
+    std::string upper = text;
+    for (size_t i = 0; i < len; ++i) {
+      unsigned char ch = static_cast<unsigned char>(text[i]);
+      if (ch < 0x80) {
+        lower[i] = static_cast<char>(std::tolower(ch));
+        upper[i] = static_cast<char>(std::toupper(ch));
+      }
+    }
+    StringView view(text.data(), text.size());
+    ASSERT_EQ(toStd(asciiLower(view)), lower) << len;
+    ASSERT_EQ(toStd(asciiUpper(view)), upper) << len;
+    String in_place(view);
+    toUpperAscii(in_place);
+    ASSERT_EQ(toStd(in_place), upper);
+    toLowerAscii(in_place);
+    ASSERT_EQ(toStd(in_place), lower);
+  }
+}
+
+TEST(StringTransformTest, IgnoreCaseCompareAndHash) {
+  std::mt19937 rng(101);
+  for (int round = 0; round < 500; ++round) {
+    std::string lhs(rng() % 80, 'a');
+    for (char& ch : lhs) {
+      ch = static_cast<char>("aBcD@[`{"[rng() % 8]);
+    }
+    std::string rhs = lhs;
+    for (char& ch : rhs) {
+      if (std::isalpha(static_cast<unsigned char>(ch)) && rng() % 2) {
+        ch = static_cast<char>(ch ^ 0x20);
+      }
+    }
+    if (!rhs.empty() && rng() % 3 == 0) {
+      rhs[rng() % rhs.size()] = '[';
+    }
+    std::string lhs_lower = toStd(asciiLower(StringView(lhs.data(), lhs.size())));
+    std::string rhs_lower = toStd(asciiLower(StringView(rhs.data(), rhs.size())));
+    StringView lhs_view(lhs.data(), lhs.size());
+    StringView rhs_view(rhs.data(), rhs.size());
+    ASSERT_EQ(equalsIgnoreCase(lhs_view, rhs_view), lhs_lower == rhs_lower);
+    ASSERT_EQ(sign(compareIgnoreCase(lhs_view, rhs_view)), sign(lhs_lower.compare(rhs_lower)));
+    if (lhs_lower == rhs_lower) {
+      ASSERT_EQ(hashIgnoreCase(lhs_view), hashIgnoreCase(rhs_view));
+    }
+  }
+  String long_key(300, 'Q');
+  EXPECT_EQ(hashIgnoreCase(long_key), hashIgnoreCase(asciiLower(long_key)));
+  EXPECT_FALSE(equalsIgnoreCase("@", "`"));
+}
+
+TEST(StringTransformTest, CaseInsensitiveHashMap) {
+  HashMap<String, int, HashIgnoreCase, EqualIgnoreCase> headers;
+  headers.insert(String("Content-Type"), 1);
+  headers.insert(String("X-Request-Id"), 2);
+  ASSERT_NE(headers.find(StringView("content-type")), nullptr);
+  EXPECT_EQ(*headers.find(StringView("CONTENT-TYPE")), 1);
+  EXPECT_EQ(*headers.find(StringView("x-request-ID")), 2);
+  EXPECT_EQ(headers.find(StringView("content-length")), nullptr);
+}
+
+TEST(StringTransformTest, Trim) {
+  EXPECT_EQ(trim(" \t\r\n value \f\v"), StringView("value"));
+  EXPECT_EQ(trimLeft("  x "), StringView("x "));
+  EXPECT_EQ(trimRight("  x "), StringView("  x"));
+  EXPECT_TRUE(trim(" \t ").empty());
+  String str("   moved to the front   ");
+  trimInPlace(str);
+  EXPECT_EQ(str, "moved to the front");
+  String blank("    ");
+  trimInPlace(blank);
+  EXPECT_EQ(blank, "");
+}
+
+TEST(StringTransformTest, ReplaceAll) {
+  EXPECT_EQ(replaceAll("a-b-c", "-", "+-+"), String("a+-+b+-+c"));
+  EXPECT_EQ(replaceAll("aaaa", "aa", "b"), String("bb"));
+  EXPECT_EQ(replaceAll("aaa", "aa", ""), String("a"));
+  EXPECT_EQ(replaceAll("none here", "xyz", "q"), String("none here"));
+  EXPECT_EQ(replaceAll("keep", "", "q"), String("keep"));
+  std::mt19937 rng(102);
+  for (size_t len = 0; len < 100; ++len) {
+    std::string text(len, 'a');
+    for (char& ch : text) {
+      ch = static_cast<char>('a' + rng() % 3);
+    }
+    std::string expected = text;
+    for (char& ch : expected) {
+      ch = ch == 'b' ? 'z' : ch;
+    }
+    String str(StringView(text.data(), text.size()));
+    replaceAll(str, 'b', 'z');
+    ASSERT_EQ(toStd(str), expected);
+  }
+}
+
+TEST(StringTransformTest, JsonRoundTrip) {
+  EXPECT_EQ(jsonEscape("say \"hi\"\n\\ \x01"), String("say \\\"hi\\\"\\n\\\\ \\u0001"));
+  std::mt19937 rng(103);
+  for (int round = 0; round < 500; ++round) {
+    std::string text = randomBytes(rng, rng() % 60);
+    String escaped = jsonEscape(StringView(text.data(), text.size()));
+    for (size_t i = 0; i < escaped.size(); ++i) {
+      ASSERT_GE(static_cast<unsigned char>(escaped.data()[i]), 0x20);
+    }
+    String back("=");
+    ASSERT_EQ(appendJsonUnescaped(back, escaped), search_npos);
+    ASSERT_EQ(toStd(back), "=" + text);
+  }
+}
+
+TEST(StringTransformTest, JsonUnescapeUnicodeAndErrors) {
+  String out;
+  EXPECT_EQ(appendJsonUnescaped(out, "\\u00e9\\ud83d\\ude00\\/"), search_npos);
+  EXPECT_EQ(out, "\xC3\xA9\xF0\x9F\x98\x80/");
+  String kept("kept");
+  EXPECT_EQ(appendJsonUnescaped(kept, "ab\\x"), 2u);
+  EXPECT_EQ(appendJsonUnescaped(kept, "ab\\u12"), 2u);
+  EXPECT_EQ(appendJsonUnescaped(kept, "\\udc00"), 0u);
+  EXPECT_EQ(appendJsonUnescaped(kept, "tab\there"), 3u);
+  EXPECT_EQ(appendJsonUnescaped(kept, "end\\"), 3u);
+  EXPECT_EQ(kept, "kept");
+}
+
+TEST(StringTransformTest, CsvRoundTrip) {
+  String line;
+  appendCsvField(line, "plain");
+  line += ',';
+  appendCsvField(line, "has,comma");
+  line += ',';
+  appendCsvField(line, "say \"hi\"");
+  EXPECT_EQ(line, "plain,\"has,comma\",\"say \"\"hi\"\"\"");
+
+  const char* fields[] = {"", "x", "a,b", "\"", "multi\nline", "tab\t;semi", "\"\"\"\""};
+  for (const char* field : fields) {
+    String quoted;
+    appendCsvField(quoted, field);
+    String back;
+    ASSERT_EQ(appendCsvUnescaped(back, quoted), search_npos) << field;
+    EXPECT_EQ(back, field);
+  }
+  String kept("kept");
+  EXPECT_EQ(appendCsvUnescaped(kept, "\"unterminated"), 13u);
+  EXPECT_EQ(appendCsvUnescaped(kept, "\"a\"b\""), 3u);
+  EXPECT_EQ(kept, "kept");
+}
+
+TEST(StringTransformTest, AppendFromOwnBuffer) {
+  String out("say \"hi\"\n");
+  appendJsonEscaped(out, StringView(out));
+  EXPECT_EQ(out, String("say \"hi\"\nsay \\\"hi\\\"\\n"));
+
+  String escaped("a\\tb\\u00e9");
+  EXPECT_EQ(appendJsonUnescaped(escaped, StringView(escaped)), search_npos);
+  EXPECT_EQ(escaped, String("a\\tb\\u00e9a\tb\xc3\xa9"));
+
+  String csv("x,\"y\"");
+  appendCsvField(csv, StringView(csv));
+  EXPECT_EQ(csv, String("x,\"y\"\"x,\"\"y\"\"\""));
+
+  String quoted("\"p\"\"q\"");
+  EXPECT_EQ(appendCsvUnescaped(quoted, StringView(quoted)), search_npos);
+  EXPECT_EQ(quoted, String("\"p\"\"q\"p\"q"));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vstl/string_view.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+std::vector<std::string> splitAll(StringView str, StringView delim) {
+  std::vector<std::string> tokens;
+  for (StringView token : str.split(delim)) {
+    tokens.emplace_back(token.data(), token.size());
+  }
+  return tokens;
+}
+
+int sign(int val) {
+  return (val > 0) - (val < 0);
+}
+
+}  // namespace
+
+TEST(StringViewTest, SubstrClampsAndThrows) {
+  StringView view("hello world");
+  EXPECT_EQ(view.substr(6), StringView("world"));
+  EXPECT_EQ(view.substr(6, 100), StringView("world"));
+  EXPECT_EQ(view.substr(0, 5), StringView("hello"));
+  EXPECT_TRUE(view.substr(11).empty());
+  EXPECT_THROW(view.substr(12), std::out_of_range);
+}
+
+TEST(StringViewTest, PrefixAndSuffix) {
+  StringView view("key=value");
+  EXPECT_TRUE(view.startsWith("key"));
+  EXPECT_TRUE(view.endsWith("value"));
+  EXPECT_FALSE(view.startsWith("key=value!"));
+  EXPECT_TRUE(view.startsWith(""));
+  view.removePrefix(4);
+  view.removeSuffix(2);
+  EXPECT_EQ(view, StringView("val"));
+}
+
+TEST(StringViewTest, FindMatchesStdStringView) {
+  std::mt19937 rng(11);
+  for (int round = 0; round < 300; ++round) {
+    std::string text(rng() % 200, 'a');
+    for (char& ch : text) {
+      ch = static_cast<char>('a' + rng() % 3);
+    }
+    std::string needle(1 + rng() % 4, 'a');
+    for (char& ch : needle) {
+      ch = static_cast<char>('a' + rng() % 3);
+    }
+    std::string_view expected(text);
+    StringView view(text.data(), text.size());
+    size_t pos = rng() % (text.size() + 2);
+    EXPECT_EQ(view.find(needle[0], pos), expected.find(needle[0], pos));
+    EXPECT_EQ(view.find(StringView(needle.c_str()), pos), expected.find(needle, pos));
+    EXPECT_EQ(view.rfind(needle[0], pos), expected.rfind(needle[0], pos));
+    EXPECT_EQ(view.rfind(StringView(needle.c_str()), pos), expected.rfind(needle, pos));
+    EXPECT_EQ(view.findFirstOf("bc", pos), expected.find_first_of("bc", pos));
+    EXPECT_EQ(view.count('b'), static_cast<size_t>(std::count(text.begin(), text.end(), 'b')));
+  }
+}
+
+TEST(StringViewTest, CompareOrdersLikeStdStringView) {
+  const char* words[] = {"", "a", "ab", "abc", "abd", "b", "\xff", "a\xff"};
+  for (const char* lhs : words) {
+    for (const char* rhs : words) {
+      std::string_view lhs_std(lhs);
+      std::string_view rhs_std(rhs);
+      EXPECT_EQ(sign(StringView(lhs).compare(rhs)), sign(lhs_std.compare(rhs_std))) << lhs << " " << rhs;
+      EXPECT_EQ(StringView(lhs) < StringView(rhs), lhs_std < rhs_std);
+      EXPECT_EQ(StringView(lhs) == StringView(rhs), lhs_std == rhs_std);
+    }
+  }
+}
+
+TEST(StringViewTest, SplitKeepsEmptyTokens) {
+  EXPECT_EQ(splitAll("a,b,,c", ","), (std::vector<std::string>{"a", "b", "", "c"}));
+  EXPECT_EQ(splitAll(",", ","), (std::vector<std::string>{"", ""}));
+  EXPECT_EQ(splitAll("", ","), (std::vector<std::string>{""}));
+  EXPECT_EQ(splitAll("one::two::", "::"), (std::vector<std::string>{"one", "two", ""}));
+  EXPECT_EQ(splitAll("no delimiter", ";"), (std::vector<std::string>{"no delimiter"}));
+}
+
+TEST(StringViewTest, SplitOnChar) {
+  std::vector<std::string> tokens;
+  for (StringView token : StringView("x y  z").split(' ')) {
+    tokens.emplace_back(token.data(), token.size());
+  }
+  EXPECT_EQ(tokens, (std::vector<std::string>{"x", "y", "", "z"}));
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vstl/utf8.hpp"
+
+using namespace stdvector;
+
+namespace {
+
+//Unicode table 3-7, byte by byte: offset of the first ill formed sequence
+size_t referenceInvalidOffset(const std::string& str) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(str.data());
+  size_t len = str.size();
+  size_t pos = 0;
+  while (pos < len) {
+    unsigned char lead = bytes[pos];
+    size_t count;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead < 0x80) {
+      ++pos;
+      continue;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+      count = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      count = 3;
+      low = lead == 0xE0 ? 0xA0 : 0x80;
+      high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      count = 4;
+      low = lead == 0xF0 ? 0x90 : 0x80;
+      high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      return pos;
+    }
+    if (len - pos < count || bytes[pos + 1] < low || bytes[pos + 1] > high) {
+      return pos;
+    }
+    for (size_t i = 2; i < count; ++i) {
+      if ((bytes[pos + i] & 0xC0) != 0x80) {
+        return pos;
+      }
+    }
+    pos += count;
+  }
+  return search_npos;
+}
+
+char32_t randomScalar(std::mt19937& rng) {
+  switch (rng() % 4) {
+    case 0:
+      return rng() % 0x80;
+    case 1:
+      return 0x80 + rng() % (0x800 - 0x80);
+    case 2: {
+      char32_t code_point = 0x800 + rng() % (0x10000 - 0x800);
+      return code_point >= 0xD800 && code_point <= 0xDFFF ? code_point - 0x800 : code_point;
+    }
+    default:
+      return 0x10000 + rng() % (0x110000 - 0x10000);
+  }
+}
+
+std::u32string randomText(std::mt19937& rng, size_t count) {
+  std::u32string text;
+  for (size_t i = 0; i < count; ++i) {
+    text.push_back(rng() % 3 == 0 ? randomScalar(rng) : static_cast<char32_t>('a' + rng() % 26));
+  }
+  return text;
+}
+
+std::string toUtf8(const std::u32string& text) {
+  String out;
+  EXPECT_EQ(appendUtf32(out, text.data(), text.size()), search_npos);
+  return std::string(out.data(), out.size());
+}
+
+}  // namespace
+
+TEST(Utf8Test, ValidTextHasNoInvalidOffset) {
+  std::mt19937 rng(90);
+  for (int round = 0; round < 300; ++round) {
+    std::string utf8 = toUtf8(randomText(rng, rng() % 200));
+    ASSERT_EQ(findInvalidUtf8(utf8.data(), utf8.size()), search_npos);
+    ASSERT_TRUE(isValidUtf8(StringView(utf8.data(), utf8.size())));
+  }
+}
+
+TEST(Utf8Test, InvalidOffsetAtEveryPosition) {
+  const char* bad_sequences[] = {
+      "\x80",              //lone continuation byte
+      "\xC0\x80",          //overlong two byte form
+      "\xC1\xBF",          //overlong two byte form
+      "\xE0\x80\x80",      //overlong three byte form
+      "\xED\xA0\x80",      //surrogate
+      "\xF0\x80\x80\x80",  //overlong four byte form
+      "\xF4\x90\x80\x80",  //past U+10FFFF
+      "\xF5\x80\x80\x80",  //lead byte that never appears
+      "\xFF",
+      "\xE2\x82",          //truncated at the end of the input
+      "\xE2\x28\xA1",      //bad second byte
+  };
+  std::mt19937 rng(91);
+  for (const char* bad : bad_sequences) {
+    //prefixes cross the 16 and 32 byte blocks, with and without multibyte text
+    for (size_t prefix_len = 0; prefix_len < 70; ++prefix_len) {
+      std::string prefix = prefix_len % 2 ? std::string(prefix_len, 'a') : toUtf8(randomText(rng, prefix_len));
+      std::string text = prefix + bad;
+      size_t expected = referenceInvalidOffset(text);
+      ASSERT_EQ(expected, prefix.size()) << prefix_len;
+      ASSERT_EQ(findInvalidUtf8(text.data(), text.size()), expected) << prefix_len;
+      std::string padded = text + std::string(40, 'z');
+      ASSERT_EQ(findInvalidUtf8(padded.data(), padded.size()), expected) << prefix_len;
+    }
+  }
+}
+
+TEST(Utf8Test, RandomBytesMatchReference) {
+  std::mt19937 rng(92);
+  for (int round = 0; round < 3000; ++round) {
+    std::string text = toUtf8(randomText(rng, rng() % 60));
+    size_t changes = rng() % 3;
+    for (size_t k = 0; k < changes && !text.empty(); ++k) {
+      text[rng() % text.size()] = static_cast<char>(rng());
+    }
+    ASSERT_EQ(findInvalidUtf8(text.data(), text.size()), referenceInvalidOffset(text));
+  }
+}
+
+#ifdef VSTL_SEARCH_AVX2
+//findInvalidUtf8 rescans flagged blocks, so check the kernels directly:
+//they must flag a block exactly when the text is invalid, no more than 3
+//bytes past the bad sequence's start
+namespace {
+
+template <size_t Width, typename Kernel>
+void checkBlockKernel(Kernel kernel) {
+  std::mt19937 rng(94);
+  for (int round = 0; round < 3000; ++round) {
+    std::string text = toUtf8(randomText(rng, rng() % 80));
+    size_t changes = rng() % 3;
+    for (size_t k = 0; k < changes && !text.empty(); ++k) {
+      text[rng() % text.size()] = static_cast<char>(rng());
+    }
+    size_t expected = referenceInvalidOffset(text);
+    size_t block = kernel(text.data(), text.size());
+    if (expected == search_npos) {
+      ASSERT_EQ(block, search_npos);
+    } else {
+      ASSERT_NE(block, search_npos);
+      ASSERT_EQ(block % Width, 0u);
+      ASSERT_LE(block, expected + 3);
+      ASSERT_LT(expected, block + Width);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Utf8Test, BlockKernelsMatchReference) {
+  if (cpuHasAvx2()) {
+    checkBlockKernel<32>(detail::findInvalidUtf8BlockAvx2);
+  }
+  if (cpuHasSsse3()) {
+    checkBlockKernel<16>(detail::findInvalidUtf8BlockSsse3);
+  }
+}
+#endif
+
+TEST(Utf8Test, CountCodePoints) {
+  std::mt19937 rng(93);
+  for (int round = 0; round < 200; ++round) {
+    std::u32string text = randomText(rng, rng() % 100);
+    std::string utf8 = toUtf8(text);
+    ASSERT_EQ(countCodePoints(StringView(utf8.data(), utf8.size())), text.size());
+  }
+}
+
+TEST(Utf8Test, Utf32RoundTrip) {
+  std::mt19937 rng(94);
+  for (int round = 0; round < 300; ++round) {
+    std::u32string text = randomText(rng, rng() % 100);
+    std::string utf8 = toUtf8(text);
+    std::u32string back(utf8.size(), U'\0');
+    TranscodeResult result = utf8ToUtf32(utf8.data(), utf8.size(), &back[0]);
+    ASSERT_EQ(result.error, search_npos);
+    back.resize(result.written);
+    ASSERT_EQ(back, text);
+  }
+}
+
+TEST(Utf8Test, Utf16RoundTrip) {
+  std::mt19937 rng(95);
+  for (int round = 0; round < 300; ++round) {
+    std::string utf8 = toUtf8(randomText(rng, rng() % 100));
+    std::u16string utf16(utf8.size(), u'\0');
+    TranscodeResult result = utf8ToUtf16(utf8.data(), utf8.size(), &utf16[0]);
+    ASSERT_EQ(result.error, search_npos);
+    utf16.resize(result.written);
+    String back("prefix:");
+    ASSERT_EQ(appendUtf16(back, utf16.data(), utf16.size()), search_npos);
+    ASSERT_EQ(std::string(back.data(), back.size()), "prefix:" + utf8);
+    ASSERT_EQ(back.c_str()[back.size()], '\0');
+  }
+}
+
+TEST(Utf8Test, TranscodeErrorsLeaveOutputUnchanged) {
+  String out("kept");
+  const char16_t lone_high[] = {u'a', u'b', 0xD800, u'c'};
+  EXPECT_EQ(appendUtf16(out, lone_high, 4), 2u);
+  const char16_t lone_low[] = {0xDC00};
+  EXPECT_EQ(appendUtf16(out, lone_low, 1), 0u);
+  const char32_t too_big[] = {U'x', 0x110000};
+  EXPECT_EQ(appendUtf32(out, too_big, 2), 1u);
+  const char32_t surrogate[] = {0xDFFF};
+  EXPECT_EQ(appendUtf32(out, surrogate, 1), 0u);
+  EXPECT_EQ(out, "kept");
+  EXPECT_EQ(out.c_str()[4], '\0');
+
+  const char bad_utf8[] = "ok\xC3(";
+  char32_t wide[8];
+  EXPECT_EQ(utf8ToUtf32(bad_utf8, 4, wide).error, 2u);
+  char16_t narrow[8];
+  EXPECT_EQ(utf8ToUtf16(bad_utf8, 4, narrow).error, 2u);
+}
+
+TEST(Utf8Test, ViewReplacesBadBytes) {
+  std::string text = "a\xC3\xA9\xFF\xF0\x9F\x98\x80\xE2\x82";
+  std::vector<char32_t> code_points;
+  std::vector<size_t> offsets;
+  Utf8View view(StringView(text.data(), text.size()));
+  for (auto it = view.begin(); it != view.end(); ++it) {
+    code_points.push_back(*it);
+    offsets.push_back(it.offset());
+  }
+  EXPECT_EQ(code_points, (std::vector<char32_t>{U'a', 0xE9, 0xFFFD, 0x1F600, 0xFFFD, 0xFFFD}));
+  EXPECT_EQ(offsets, (std::vector<size_t>{0, 1, 3, 4, 8, 9}));
+}
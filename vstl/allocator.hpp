@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#include "object_pool.hpp"
+
+//General purpose allocator: requests up to 32K are rounded to one of 40
+//size classes, each served by its own FixedPool (thread caches in front of
+//a central free list refilled in batches); bigger ones are mapped directly.
+//Deallocation is sized, the caller passes back the size it asked for.
+//
+//Containers use it through allocateBytes/deallocateBytes, which fall back
+//to plain new/delete unless VSTL_CACHING_ALLOCATOR is defined.
+
+namespace stdvector {
+
+struct LargeStats {
+    size_t live_blocks;
+    size_t live_bytes;
+    size_t total_blocks;   //mapped since start
+};
+
+class CachingAllocator {
+  public:
+    static constexpr size_t class_count = 40;
+    static constexpr size_t max_small = 32 * 1024;
+
+    //16 byte steps up to 128, then four classes per power of two
+    static constexpr size_t classSize(size_t idx) {
+        if (idx < 8) {
+            return (idx + 1) * 16;
+        }
+        size_t shift = 7 + (idx - 8) / 4;
+        return (size_t(1) << shift) + ((idx - 8) % 4 + 1) * (size_t(1) << (shift - 2));
+    }
+
+    static size_t classIndex(size_t bytes) {
+        if (bytes <= 128) {
+            return bytes == 0 ? 0 : (bytes - 1) / 16;
+        }
+        size_t shift = log2(bytes - 1);
+        return 8 + (shift - 7) * 4 + ((bytes - 1 - (size_t(1) << shift)) >> (shift - 2));
+    }
+
+    static void* allocate(size_t bytes) {
+        if (bytes > max_small) {
+            return allocateLarge(bytes);
+        }
+        return table().entries[classIndex(bytes)].allocate();
+    }
+
+    static void deallocate(void* ptr, size_t bytes) {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (bytes > max_small) {
+            deallocateLarge(ptr, bytes);
+            return;
+        }
+        table().entries[classIndex(bytes)].deallocate(ptr);
+    }
+
+    static PoolStats classStats(size_t idx) {
+        return table().entries[idx].stats();
+    }
+
+    static LargeStats largeStats() {
+        Large& large = largeCounters();
+        return LargeStats{large.live_blocks.load(std::memory_order_relaxed),
+                          large.live_bytes.load(std::memory_order_relaxed),
+                          large.total_blocks.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    struct Entry {
+        void* (*allocate)();
+        void (*deallocate)(void*);
+        PoolStats (*stats)();
+    };
+
+    struct Table {
+        Entry entries[class_count];
+    };
+
+    template <size_t... Idx>
+    static constexpr Table makeTable(std::index_sequence<Idx...>) {
+        return Table{{Entry{&FixedPool<classSize(Idx)>::allocate,
+                            &FixedPool<classSize(Idx)>::deallocate,
+                            &FixedPool<classSize(Idx)>::stats}...}};
+    }
+
+    static const Table& table() {
+        static constexpr Table result = makeTable(std::make_index_sequence<class_count>());
+        return result;
+    }
+
+    static size_t log2(size_t value) {
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value);
+    }
+
+    //large blocks are rare, shared atomic counters are fine here
+    struct Large {
+        std::atomic<size_t> live_blocks;
+        std::atomic<size_t> live_bytes;
+        std::atomic<size_t> total_blocks;
+    };
+
+    static Large& largeCounters() {
+        static Large counters = {{0}, {0}, {0}};
+        return counters;
+    }
+
+    static void* allocateLarge(size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#else
+        void* ptr = ::operator new(bytes);
+#endif
+        Large& large = largeCounters();
+        large.live_blocks.fetch_add(1, std::memory_order_relaxed);
+        large.live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        large.total_blocks.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    static void deallocateLarge(void* ptr, size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(ptr, bytes);
+#else
+        ::operator delete(ptr);
+#endif
+        Large& large = largeCounters();
+        large.live_blocks.fetch_sub(1, std::memory_order_relaxed);
+        large.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+};
+
+//Types whose objects can be moved to new storage by copying their bytes
+//and abandoning the old ones, without running move constructor and
+//destructor. Containers use memcpy to grow storage for them.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+inline void* allocateBytes(size_t bytes) {
+#ifdef VSTL_CACHING_ALLOCATOR
+    return CachingAllocator::allocate(bytes);
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+inline void deallocateBytes(void* ptr, size_t bytes) {
+#ifdef VSTL_CACHING_ALLOCATOR
+    CachingAllocator::deallocate(ptr, bytes);
+#else
+    (void)bytes;
+    ::operator delete(ptr);
+#endif
+}
+
+//size classes and new both give max_align_t alignment, stricter requests
+//go to aligned new; free with the same alignment
+inline void* allocateBytes(size_t bytes, size_t alignment) {
+    if (alignment <= alignof(std::max_align_t)) {
+        return allocateBytes(bytes);
+    }
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+inline void deallocateBytes(void* ptr, size_t bytes, size_t alignment) {
+    if (alignment <= alignof(std::max_align_t)) {
+        deallocateBytes(ptr, bytes);
+        return;
+    }
+    ::operator delete(ptr, std::align_val_t(alignment));
+}
+
+} //namespace stdvector
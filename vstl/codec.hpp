@@ -0,0 +1,373 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "string.hpp"
+#include "string_search.hpp"
+#include "string_transform.hpp"
+#include "string_view.hpp"
+#include "utf8.hpp"
+
+//Base64 (RFC 4648 standard and URL-safe alphabets) and hex codecs between
+//binary data and text. Encoders write into a caller buffer of the exact
+//size or append to a String sized once up front; decoders report the
+//offset of the first character they cannot accept.
+//
+//Base64 runs 24 bytes <-> 32 chars per AVX2 step (Mula and Lemire's
+//multiply-shift packing with a nibble table lookup), hex 16 bytes per
+//SSE2 step; both finish with table driven scalar code.
+
+namespace stdvector {
+
+enum class Base64Alphabet {
+    standard,   //+ and /
+    url,        //- and _
+};
+
+namespace detail {
+
+inline const char* base64Chars(Base64Alphabet alphabet) {
+    return alphabet == Base64Alphabet::standard
+               ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+               : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+}
+
+//char -> 6-bit value, 0xFF for chars outside the alphabet
+struct Base64DecodeTable {
+    uint8_t values[256];
+
+    explicit Base64DecodeTable(Base64Alphabet alphabet) {
+        std::memset(values, 0xFF, sizeof(values));
+        const char* chars = base64Chars(alphabet);
+        for (uint8_t i = 0; i < 64; ++i) {
+            values[static_cast<unsigned char>(chars[i])] = i;
+        }
+    }
+};
+
+inline const Base64DecodeTable& base64DecodeTable(Base64Alphabet alphabet) {
+    static const Base64DecodeTable standard(Base64Alphabet::standard);
+    static const Base64DecodeTable url(Base64Alphabet::url);
+    return alphabet == Base64Alphabet::standard ? standard : url;
+}
+
+#ifdef VSTL_SEARCH_AVX2
+
+//needs 28 readable bytes at src + pos per step, writes 32 chars
+__attribute__((target("avx2"))) inline void base64EncodeAvx2(const unsigned char* src, size_t len, char* dst,
+                                                               Base64Alphabet alphabet, size_t& pos, size_t& out) {
+    const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    //offset to add to each 6-bit index, picked by its range (see below)
+    const char last_two[2] = {alphabet == Base64Alphabet::standard ? '+' : '-',
+                              alphabet == Base64Alphabet::standard ? '/' : '_'};
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, static_cast<char>(last_two[0] - 62), static_cast<char>(last_two[1] - 63), 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, static_cast<char>(last_two[0] - 62), static_cast<char>(last_two[1] - 63), 'A', 0, 0);
+    for (; pos + 28 <= len; pos += 24, out += 32) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos + 12));
+        __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), spread);
+        //every 32-bit lane now holds one 3 byte group; cut it into four
+        //6-bit indices, one per byte
+        __m256i first = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)),
+                                           _mm256_set1_epi32(0x04000040));
+        __m256i second = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)),
+                                            _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(first, second);
+        //0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i letters = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(letters, _mm256_set1_epi8(13)));
+        __m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift_lut, range));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + out), chars);
+    }
+}
+
+//stops before the first block holding anything outside the alphabet
+__attribute__((target("avx2"))) inline void base64DecodeAvx2(const char* src, size_t len, char* dst,
+                                                               Base64Alphabet alphabet, size_t& pos, size_t& out) {
+    const __m256i char_62 = _mm256_set1_epi8(alphabet == Base64Alphabet::standard ? '+' : '-');
+    const __m256i char_63 = _mm256_set1_epi8(alphabet == Base64Alphabet::standard ? '/' : '_');
+    const __m256i store_mask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+    for (; pos + 32 <= len; pos += 32, out += 24) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + pos));
+        //ranges checked as offsets from -128, one signed compare each
+        __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26),
+                                          _mm256_sub_epi8(in, _mm256_set1_epi8(static_cast<char>('A' + 128))));
+        __m256i lower = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26),
+                                          _mm256_sub_epi8(in, _mm256_set1_epi8(static_cast<char>('a' + 128))));
+        __m256i digit = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 10),
+                                          _mm256_sub_epi8(in, _mm256_set1_epi8(static_cast<char>('0' + 128))));
+        __m256i is_62 = _mm256_cmpeq_epi8(in, char_62);
+        __m256i is_63 = _mm256_cmpeq_epi8(in, char_63);
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is_62, is_63)));
+        if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu) {
+            return;
+        }
+        __m256i values = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(upper, _mm256_sub_epi8(in, _mm256_set1_epi8('A'))),
+                            _mm256_and_si256(lower, _mm256_sub_epi8(in, _mm256_set1_epi8('a' - 26)))),
+            _mm256_or_si256(_mm256_and_si256(digit, _mm256_add_epi8(in, _mm256_set1_epi8(52 - '0'))),
+                            _mm256_or_si256(_mm256_and_si256(is_62, _mm256_set1_epi8(62)),
+                                            _mm256_and_si256(is_63, _mm256_set1_epi8(63)))));
+        //four 6-bit values per 32-bit lane -> three bytes, then drop the gaps
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        groups = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        groups = _mm256_permutevar8x32_epi32(groups, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(dst + out), store_mask, groups);
+    }
+}
+
+#endif //VSTL_SEARCH_AVX2
+
+} //namespace detail
+
+inline size_t base64EncodedSize(size_t len, bool padding = true) {
+    return padding ? (len + 2) / 3 * 4 : len / 3 * 4 + (len % 3 == 0 ? 0 : len % 3 + 1);
+}
+
+//writes base64EncodedSize(len, padding) chars, returns their end
+inline char* base64Encode(const void* src, size_t len, char* dst,
+                          Base64Alphabet alphabet = Base64Alphabet::standard, bool padding = true) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(src);
+    const char* chars = detail::base64Chars(alphabet);
+    size_t pos = 0;
+    size_t out = 0;
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        detail::base64EncodeAvx2(bytes, len, dst, alphabet, pos, out);
+    }
+#endif
+    for (; pos + 3 <= len; pos += 3, out += 4) {
+        uint32_t group = (uint32_t(bytes[pos]) << 16) | (uint32_t(bytes[pos + 1]) << 8) | bytes[pos + 2];
+        dst[out] = chars[group >> 18];
+        dst[out + 1] = chars[(group >> 12) & 63];
+        dst[out + 2] = chars[(group >> 6) & 63];
+        dst[out + 3] = chars[group & 63];
+    }
+    if (pos < len) {
+        uint32_t group = uint32_t(bytes[pos]) << 16;
+        if (pos + 1 < len) {
+            group |= uint32_t(bytes[pos + 1]) << 8;
+        }
+        dst[out++] = chars[group >> 18];
+        dst[out++] = chars[(group >> 12) & 63];
+        if (pos + 1 < len) {
+            dst[out++] = chars[(group >> 6) & 63];
+        } else if (padding) {
+            dst[out++] = '=';
+        }
+        if (padding) {
+            dst[out++] = '=';
+        }
+    }
+    return dst + out;
+}
+
+//src may point into out
+inline void appendBase64(String& out, const void* src, size_t len,
+                         Base64Alphabet alphabet = Base64Alphabet::standard, bool padding = true) {
+    if (detail::StringTail::aliases(out, src)) {
+        appendBase64(out, String(StringView(static_cast<const char*>(src), len)).data(), len, alphabet, padding);
+        return;
+    }
+    size_t old_size = out.size();
+    char* dst = detail::StringTail::grow(out, base64EncodedSize(len, padding));
+    detail::StringTail::commit(out, old_size + (base64Encode(src, len, dst, alphabet, padding) - dst));
+}
+
+inline String base64Encode(StringView src, Base64Alphabet alphabet = Base64Alphabet::standard, bool padding = true) {
+    String result;
+    appendBase64(result, src.data(), src.size(), alphabet, padding);
+    return result;
+}
+
+//bytes that valid input decodes to; padding is optional
+inline size_t base64DecodedSize(StringView src) {
+    size_t len = src.size();
+    if (len % 4 == 0 && len > 0 && src[len - 1] == '=') {
+        len -= src[len - 2] == '=' ? 2 : 1;
+    }
+    return len / 4 * 3 + (len % 4 == 0 ? 0 : len % 4 - 1);
+}
+
+//Decodes padded or unpadded input into dst, which needs room for
+//base64DecodedSize(src) bytes. error is the offset of the first char that
+//is out of the alphabet or out of place (search_npos if none).
+inline TranscodeResult base64Decode(StringView src, char* dst, Base64Alphabet alphabet = Base64Alphabet::standard) {
+    size_t len = src.size();
+    if (len % 4 == 0 && len > 0 && src[len - 1] == '=') {
+        len -= src[len - 2] == '=' ? 2 : 1;
+    }
+    const uint8_t* table = detail::base64DecodeTable(alphabet).values;
+    const char* chars = src.data();
+    size_t pos = 0;
+    size_t out = 0;
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        detail::base64DecodeAvx2(chars, len, dst, alphabet, pos, out);
+    }
+#endif
+    for (; pos + 4 <= len; pos += 4, out += 3) {
+        uint32_t group = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            uint8_t value = table[static_cast<unsigned char>(chars[pos + i])];
+            if (value == 0xFF) {
+                return TranscodeResult{out, pos + i};
+            }
+            group = (group << 6) | value;
+        }
+        dst[out] = static_cast<char>(group >> 16);
+        dst[out + 1] = static_cast<char>(group >> 8);
+        dst[out + 2] = static_cast<char>(group);
+    }
+    size_t rest = len - pos;
+    if (rest == 1) {
+        return TranscodeResult{out, pos};
+    }
+    if (rest > 1) {
+        uint32_t group = 0;
+        for (size_t i = 0; i < rest; ++i) {
+            uint8_t value = table[static_cast<unsigned char>(chars[pos + i])];
+            if (value == 0xFF) {
+                return TranscodeResult{out, pos + i};
+            }
+            group = (group << 6) | value;
+        }
+        group <<= 6 * (4 - rest);
+        dst[out++] = static_cast<char>(group >> 16);
+        if (rest == 3) {
+            dst[out++] = static_cast<char>(group >> 8);
+        }
+    }
+    return TranscodeResult{out, search_npos};
+}
+
+//search_npos, or the error offset with out left unchanged; src may view out
+inline size_t appendBase64Decoded(String& out, StringView src, Base64Alphabet alphabet = Base64Alphabet::standard) {
+    if (detail::StringTail::aliases(out, src.data())) {
+        return appendBase64Decoded(out, String(src), alphabet);
+    }
+    size_t old_size = out.size();
+    TranscodeResult result = base64Decode(src, detail::StringTail::grow(out, base64DecodedSize(src)), alphabet);
+    detail::StringTail::commit(out, result.error == search_npos ? old_size + result.written : old_size);
+    return result.error;
+}
+
+//writes 2 * len chars, returns their end
+inline char* hexEncode(const void* src, size_t len, char* dst, bool upper = false) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(src);
+    size_t pos = 0;
+#ifdef __SSE2__
+    //nibble n becomes '0' + n, plus the gap to 'a' (or 'A') when n > 9
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i letter_gap = _mm_set1_epi8(static_cast<char>((upper ? 'A' : 'a') - '0' - 10));
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), low_nibble);
+        __m128i low = _mm_and_si128(block, low_nibble);
+        __m128i first = _mm_unpacklo_epi8(high, low);
+        __m128i second = _mm_unpackhi_epi8(high, low);
+        first = _mm_add_epi8(_mm_add_epi8(first, zero_char), _mm_and_si128(_mm_cmpgt_epi8(first, nine), letter_gap));
+        second = _mm_add_epi8(_mm_add_epi8(second, zero_char), _mm_and_si128(_mm_cmpgt_epi8(second, nine), letter_gap));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pos), first);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pos + 16), second);
+    }
+#endif
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    for (; pos < len; ++pos) {
+        dst[2 * pos] = digits[bytes[pos] >> 4];
+        dst[2 * pos + 1] = digits[bytes[pos] & 15];
+    }
+    return dst + 2 * len;
+}
+
+//src may point into out
+inline void appendHexEncoded(String& out, const void* src, size_t len, bool upper = false) {
+    if (detail::StringTail::aliases(out, src)) {
+        appendHexEncoded(out, String(StringView(static_cast<const char*>(src), len)).data(), len, upper);
+        return;
+    }
+    size_t old_size = out.size();
+    char* dst = detail::StringTail::grow(out, 2 * len);
+    detail::StringTail::commit(out, old_size + (hexEncode(src, len, dst, upper) - dst));
+}
+
+inline String hexEncode(StringView src, bool upper = false) {
+    String result;
+    appendHexEncoded(result, src.data(), src.size(), upper);
+    return result;
+}
+
+//Digits of either case into dst, which needs room for src.size() / 2
+//bytes. An odd count is an error at src.size().
+inline TranscodeResult hexDecode(StringView src, char* dst) {
+    const char* chars = src.data();
+    size_t len = src.size() & ~size_t(1);
+    size_t pos = 0;
+#ifdef __SSE2__
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    for (; pos + 32 <= len; pos += 32) {
+        __m128i values[2];
+        bool valid = true;
+        for (size_t half = 0; half < 2; ++half) {
+            __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + pos + 16 * half));
+            __m128i digit_value = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+            __m128i is_digit = _mm_cmplt_epi8(_mm_sub_epi8(in, _mm_set1_epi8(static_cast<char>('0' + 128))),
+                                              _mm_set1_epi8(-128 + 10));
+            __m128i folded = _mm_or_si128(in, case_bit);
+            __m128i letter_value = _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10));
+            __m128i is_letter = _mm_cmplt_epi8(_mm_sub_epi8(folded, _mm_set1_epi8(static_cast<char>('a' + 128))),
+                                               _mm_set1_epi8(-128 + 6));
+            valid = valid && _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) == 0xFFFF;
+            values[half] = _mm_or_si128(_mm_and_si128(is_digit, digit_value), _mm_and_si128(is_letter, letter_value));
+        }
+        if (!valid) {
+            break;
+        }
+        //each 16-bit lane holds (low byte) high nibble and (high byte) low nibble
+        __m128i first = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values[0], _mm_set1_epi16(0x00FF)), 4),
+                                     _mm_srli_epi16(values[0], 8));
+        __m128i second = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values[1], _mm_set1_epi16(0x00FF)), 4),
+                                      _mm_srli_epi16(values[1], 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos / 2), _mm_packus_epi16(first, second));
+    }
+#endif
+    for (; pos < len; pos += 2) {
+        int high = detail::hexValue(chars[pos]);
+        if (high < 0) {
+            return TranscodeResult{pos / 2, pos};
+        }
+        int low = detail::hexValue(chars[pos + 1]);
+        if (low < 0) {
+            return TranscodeResult{pos / 2, pos + 1};
+        }
+        dst[pos / 2] = static_cast<char>((high << 4) | low);
+    }
+    if (len != src.size()) {
+        return TranscodeResult{len / 2, src.size()};
+    }
+    return TranscodeResult{len / 2, search_npos};
+}
+
+//search_npos, or the error offset with out left unchanged; src may view out
+inline size_t appendHexDecoded(String& out, StringView src) {
+    if (detail::StringTail::aliases(out, src.data())) {
+        return appendHexDecoded(out, String(src));
+    }
+    size_t old_size = out.size();
+    TranscodeResult result = hexDecode(src, detail::StringTail::grow(out, src.size() / 2));
+    detail::StringTail::commit(out, result.error == search_npos ? old_size + result.written : old_size);
+    return result.error;
+}
+
+} //namespace stdvector
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <shared_mutex>
+#include <mutex>
+#include <type_traits>
+
+#include "hash_map.hpp"
+
+//Hash map shared between threads: keys are spread over independently
+//locked HashMap shards, so writers to different shards never contend and
+//each shard rehashes on its own. Readers take the shard lock shared. A key
+//is hashed once: the hash picks the shard and is handed to its HashMap.
+
+namespace stdvector {
+
+template <typename Key, typename Value, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>>
+class ConcurrentHashMap {
+  public:
+    //shard_count is rounded up to a power of two
+    explicit ConcurrentHashMap(size_t shard_count = 64) : shard_bits_(0) {
+        while ((size_t(1) << shard_bits_) < shard_count) {
+            ++shard_bits_;
+        }
+        shards_ = new Shard[size_t(1) << shard_bits_];
+    }
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ~ConcurrentHashMap() {
+        delete[] shards_;
+    }
+
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    //copies the value out, a pointer would outlive the shard lock
+    template <typename K>
+    bool find(const K& key, Value& out) const {
+        uint64_t hash = hasher_(key);
+        const Shard& shard = shardFor(hash);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const Value* value = shard.map.findHashed(key, hash);
+        if (value == nullptr) {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+
+    template <typename K>
+    bool contains(const K& key) const {
+        uint64_t hash = hasher_(key);
+        const Shard& shard = shardFor(hash);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.containsHashed(key, hash);
+    }
+
+    bool insert(const Key& key, const Value& value) {
+        uint64_t hash = hasher_(key);
+        Shard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.insertHashed(key, value, hash);
+    }
+
+    void insertOrAssign(const Key& key, const Value& value) {
+        uint64_t hash = hasher_(key);
+        Shard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.map.insertOrAssignHashed(key, value, hash);
+    }
+
+    //updater (a lambda or vstl::Function<Value, const Value*>) gets the
+    //current value, or nullptr if key is absent, and returns the value to
+    //store; runs under the shard lock. Only callables select this overload,
+    //values that merely convert to Value go to the one above.
+    template <typename Updater,
+              typename = std::enable_if_t<std::is_invocable_r<Value, Updater&, const Value*>::value>>
+    Value insertOrAssign(const Key& key, Updater&& updater) {
+        uint64_t hash = hasher_(key);
+        Shard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Value* current = shard.map.findHashed(key, hash);
+        if (current != nullptr) {
+            *current = updater(static_cast<const Value*>(current));
+            return *current;
+        }
+        //callback first, a throw must not leave a placeholder behind
+        Value fresh = updater(nullptr);
+        shard.map.insertHashed(key, fresh, hash);
+        return fresh;
+    }
+
+    //factory (a lambda or vstl::Function<Value, const Key&>) runs at most
+    //once per key, under the shard lock; lookups of present keys only take
+    //the lock shared
+    template <typename Factory,
+              typename = std::enable_if_t<std::is_invocable_r<Value, Factory&, const Key&>::value>>
+    Value computeIfAbsent(const Key& key, Factory&& factory) {
+        uint64_t hash = hasher_(key);
+        Shard& shard = shardFor(hash);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            const Value* value = shard.map.findHashed(key, hash);
+            if (value != nullptr) {
+                return *value;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const Value* value = shard.map.findHashed(key, hash);
+        if (value != nullptr) {
+            return *value;
+        }
+        Value fresh = factory(key);
+        shard.map.insertHashed(key, fresh, hash);
+        return fresh;
+    }
+
+    template <typename K>
+    bool erase(const K& key) {
+        uint64_t hash = hasher_(key);
+        Shard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.eraseHashed(key, hash);
+    }
+
+    //spreads count evenly, assumes a reasonably uniform hash
+    void reserve(size_t count) {
+        size_t per_shard = (count >> shard_bits_) + 1;
+        for (size_t i = 0; i < shardCount(); ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+            shards_[i].map.reserve(per_shard);
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shardCount(); ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+            shards_[i].map.clear();
+        }
+    }
+
+    //not a snapshot: shards are counted one after another
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount(); ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+            total += shards_[i].map.size();
+        }
+        return total;
+    }
+
+    size_t shardCount() const {
+        return size_t(1) << shard_bits_;
+    }
+
+  private:
+    //own cache line per shard so neighbouring locks do not false share
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        HashMap<Key, Value, Hasher, KeyEqual> map;
+    };
+
+    //top bits pick the shard, HashMap itself uses the low ones
+    size_t shardIndex(uint64_t hash) const {
+        if (shard_bits_ == 0) {
+            return 0;
+        }
+        return static_cast<size_t>(hash >> (64 - shard_bits_));
+    }
+    Shard& shardFor(uint64_t hash) {
+        return shards_[shardIndex(hash)];
+    }
+    const Shard& shardFor(uint64_t hash) const {
+        return shards_[shardIndex(hash)];
+    }
+
+    Shard* shards_;
+    size_t shard_bits_;
+    Hasher hasher_;
+};
+
+} //namespace stdvector
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <utility>
+#include <new>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "vector2.hpp"
+
+//Bounded lock-free queues for handing work between threads. try* calls
+//never block; push/pop spin for a while and then park on a condition
+//variable until a try* call on the other side makes progress.
+
+namespace stdvector {
+
+const size_t cache_line_size = 64;
+
+inline void cpuRelax() {
+#ifdef __SSE2__
+    _mm_pause();
+#endif
+}
+
+//Spin-then-sleep waiting. ready() runs under the parker mutex, so it must
+//only read state. Notify is a fence and a load unless somebody went to sleep.
+class QueueParker {
+  public:
+    QueueParker() : waiters_(0) {}
+
+    template <typename Pred>
+    void wait(Pred ready) {
+        for (size_t i = 0; i < spin_count; ++i) {
+            if (ready()) {
+                return;
+            }
+            cpuRelax();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv_.wait(lock, ready);
+        waiters_.fetch_sub(1);
+    }
+
+    //call after the state change that may satisfy a waiter
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+  private:
+    static const size_t spin_count = 1024;
+
+    std::atomic<size_t> waiters_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+//Single producer, single consumer ring. Each side keeps a cached copy of
+//the other side's index and only rereads the shared one when the cache
+//says the queue is full (or empty).
+template <typename T, size_t N = 0, template <typename, size_t> class Storage = DynamicMemory>
+class SpscQueue : protected Storage<T, N> {
+    static_assert((N & (N - 1)) == 0, "queue capacity must be a power of two");
+
+  public:
+    //capacity is rounded up to a power of two; StaticMemory always holds N
+    //and throws std::overflow_error if asked for more
+    explicit SpscQueue(size_t capacity = N) : Storage<T, N>(), tail_(0), cached_head_(0), head_(0), cached_tail_(0) {
+        while (this->Storage<T, N>::capacity() < capacity) {
+            this->storageRealloc(0, 0);
+        }
+        mask_ = this->Storage<T, N>::capacity() - 1;
+    }
+    SpscQueue(const SpscQueue&) = delete;
+    ~SpscQueue() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (size_t pos = head_.load(std::memory_order_relaxed); pos != tail; ++pos) {
+            this->data()[pos & mask_].~T();
+        }
+    }
+
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    //producer side
+    bool tryPush(const T& val) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (!hasRoom(tail, 1)) {
+            return false;
+        }
+        this->Storage<T, N>::insert(tail & mask_, val);
+        tail_.store(tail + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+    bool tryPush(T&& val) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (!hasRoom(tail, 1)) {
+            return false;
+        }
+        this->Storage<T, N>::insert(tail & mask_, std::move(val));
+        tail_.store(tail + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    //pushes as many of count as fit with a single publish, returns how many
+    size_t tryPushN(const T* src, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t room = capacity() - (tail - cached_head_);
+        if (room < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            room = capacity() - (tail - cached_head_);
+        }
+        if (count > room) {
+            count = room;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            this->Storage<T, N>::insert((tail + i) & mask_, src[i]);
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        not_empty_.notify();
+        return count;
+    }
+
+    void push(const T& val) {
+        while (!tryPush(val)) {
+            not_full_.wait([&] { return size() < capacity(); });
+        }
+    }
+    void push(T&& val) {
+        while (!tryPush(std::move(val))) {
+            not_full_.wait([&] { return size() < capacity(); });
+        }
+    }
+
+    //consumer side
+    bool tryPop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        T& slot = this->data()[head & mask_];
+        out = std::move(slot);
+        slot.~T();
+        head_.store(head + 1, std::memory_order_release);
+        not_full_.notify();
+        return true;
+    }
+
+    size_t tryPopN(T* dst, size_t count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        if (count > cached_tail_ - head) {
+            count = cached_tail_ - head;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            T& slot = this->data()[(head + i) & mask_];
+            dst[i] = std::move(slot);
+            slot.~T();
+        }
+        head_.store(head + count, std::memory_order_release);
+        not_full_.notify();
+        return count;
+    }
+
+    void pop(T& out) {
+        while (!tryPop(out)) {
+            not_empty_.wait([&] { return size() > 0; });
+        }
+    }
+
+    //approximate while both sides are running
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+  private:
+    bool hasRoom(size_t tail, size_t count) {
+        if (tail - cached_head_ + count <= capacity()) {
+            return true;
+        }
+        cached_head_ = head_.load(std::memory_order_acquire);
+        return tail - cached_head_ + count <= capacity();
+    }
+
+    size_t mask_;
+
+    //written by the producer
+    alignas(cache_line_size) std::atomic<size_t> tail_;
+    size_t cached_head_;
+
+    //written by the consumer
+    alignas(cache_line_size) std::atomic<size_t> head_;
+    size_t cached_tail_;
+
+    alignas(cache_line_size) QueueParker not_full_;
+    QueueParker not_empty_;
+};
+
+//Multi producer, multi consumer queue after Dmitry Vyukov: every cell has
+//a sequence number telling which lap of producers or consumers may use it
+//next, so both sides only contend on a single CAS of their own index.
+template <typename T>
+class MpmcQueue {
+  public:
+    //capacity is rounded up to a power of two
+    explicit MpmcQueue(size_t capacity) : enqueue_pos_(0), dequeue_pos_(0) {
+        size_t real_capacity = 2;
+        while (real_capacity < capacity) {
+            real_capacity *= 2;
+        }
+        mask_ = real_capacity - 1;
+        cells_ = new Cell[real_capacity];
+        for (size_t i = 0; i < real_capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpmcQueue(const MpmcQueue&) = delete;
+    ~MpmcQueue() {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != tail; ++pos) {
+            reinterpret_cast<T*>(cells_[pos & mask_].storage)->~T();
+        }
+        delete[] cells_;
+    }
+
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    bool tryPush(const T& val) {
+        size_t pos = 0;
+        if (!claim(enqueue_pos_, 0, pos)) {
+            return false;
+        }
+        Cell& cell = cells_[pos & mask_];
+        new(cell.storage) T(val);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+    bool tryPush(T&& val) {
+        size_t pos = 0;
+        if (!claim(enqueue_pos_, 0, pos)) {
+            return false;
+        }
+        Cell& cell = cells_[pos & mask_];
+        new(cell.storage) T(std::move(val));
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    //claims a run of free cells with one CAS, returns how many were pushed
+    size_t tryPushN(const T* src, size_t count) {
+        size_t pos = 0;
+        count = claimRun(enqueue_pos_, 0, count, pos);
+        for (size_t i = 0; i < count; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            new(cell.storage) T(src[i]);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        not_empty_.notify();
+        return count;
+    }
+
+    void push(const T& val) {
+        while (!tryPush(val)) {
+            not_full_.wait([&] { return size() < capacity(); });
+        }
+    }
+    void push(T&& val) {
+        while (!tryPush(std::move(val))) {
+            not_full_.wait([&] { return size() < capacity(); });
+        }
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = 0;
+        if (!claim(dequeue_pos_, 1, pos)) {
+            return false;
+        }
+        popCell(pos, out);
+        not_full_.notify();
+        return true;
+    }
+
+    size_t tryPopN(T* dst, size_t count) {
+        size_t pos = 0;
+        count = claimRun(dequeue_pos_, 1, count, pos);
+        for (size_t i = 0; i < count; ++i) {
+            popCell(pos + i, dst[i]);
+        }
+        not_full_.notify();
+        return count;
+    }
+
+    void pop(T& out) {
+        while (!tryPop(out)) {
+            not_empty_.wait([&] { return size() > 0; });
+        }
+    }
+
+    //approximate, counts claimed but not yet published cells
+    size_t size() const {
+        size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    //a cell is ready for position pos when its sequence is pos + lag,
+    //lag is 0 for producers and 1 for consumers
+    bool claim(std::atomic<size_t>& index, size_t lag, size_t& pos) {
+        pos = index.load(std::memory_order_relaxed);
+        while (true) {
+            size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + lag);
+            if (diff == 0) {
+                if (index.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t claimRun(std::atomic<size_t>& index, size_t lag, size_t count, size_t& pos) {
+        pos = index.load(std::memory_order_relaxed);
+        while (count > 0) {
+            size_t ready = 0;
+            while (ready < count &&
+                   cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire) == pos + ready + lag) {
+                ++ready;
+            }
+            if (ready == 0) {
+                size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + lag) < 0) {
+                    return 0;
+                }
+                pos = index.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (index.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                return ready;
+            }
+        }
+        return 0;
+    }
+
+    void popCell(size_t pos, T& out) {
+        Cell& cell = cells_[pos & mask_];
+        T* ptr = reinterpret_cast<T*>(cell.storage);
+        out = std::move(*ptr);
+        ptr->~T();
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    }
+
+    Cell* cells_;
+    size_t mask_;
+
+    alignas(cache_line_size) std::atomic<size_t> enqueue_pos_;
+    alignas(cache_line_size) std::atomic<size_t> dequeue_pos_;
+
+    alignas(cache_line_size) QueueParker not_full_;
+    QueueParker not_empty_;
+};
+
+} //namespace stdvector
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <initializer_list>
+
+#include "vector2.hpp"
+
+//Sorted associative containers on top of contiguous Vector storage.
+//Keys and values are kept in separate arrays so lookups only touch keys.
+
+namespace stdvector {
+
+//lower bound without data-dependent branches, compiles to cmov
+template <typename Key, typename K, typename Compare>
+size_t branchlessLowerBound(const Key* first, size_t len, const K& key, const Compare& comp) {
+    if (len == 0) {
+        return 0;
+    }
+    const Key* base = first;
+    while (len > 1) {
+        size_t half = len / 2;
+        base = comp(base[half], key) ? base + half : base;
+        len -= half;
+    }
+    return (base - first) + comp(*base, key);
+}
+
+template <typename Key, typename Compare = std::less<>>
+class FlatSet {
+  public:
+    FlatSet() {}
+    FlatSet(std::initializer_list<Key> list) {
+        insert(list.begin(), list.end());
+    }
+    template <typename It>
+    FlatSet(It first, It last) {
+        insert(first, last);
+    }
+
+    template <typename K>
+    size_t lowerBound(const K& key) const {
+        return branchlessLowerBound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    template <typename K>
+    bool contains(const K& key) const {
+        size_t pos = lowerBound(key);
+        return pos != keys_.size() && !comp_(key, keys_.data()[pos]);
+    }
+
+    bool insert(const Key& key) {
+        size_t pos = lowerBound(key);
+        if (pos != keys_.size() && !comp_(key, keys_.data()[pos])) {
+            return false;
+        }
+        keys_.insert(pos, key);
+        return true;
+    }
+
+    //bulk load: sort the new keys once, drop known ones, merge from the back
+    template <typename It>
+    void insert(It first, It last) {
+        Vector<Key> batch;
+        for (; first != last; ++first) {
+            batch.pushBack(*first);
+        }
+        std::sort(batch.data(), batch.data() + batch.size(), comp_);
+
+        size_t fresh = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const Key& key = batch.data()[i];
+            if (fresh > 0 && !comp_(batch.data()[fresh - 1], key)) {
+                continue;
+            }
+            if (contains(key)) {
+                continue;
+            }
+            batch.data()[fresh++] = std::move(batch.data()[i]);
+        }
+        if (fresh == 0) {
+            return;
+        }
+
+        size_t old_size = keys_.size();
+        for (size_t i = 0; i < fresh; ++i) {
+            keys_.pushBack(Key());
+        }
+
+        Key* dst = keys_.data();
+        Key* src = batch.data();
+        size_t i = old_size;
+        size_t j = fresh;
+        size_t out = old_size + fresh;
+        while (j > 0) {
+            if (i > 0 && comp_(src[j - 1], dst[i - 1])) {
+                dst[--out] = std::move(dst[--i]);
+            } else {
+                dst[--out] = std::move(src[--j]);
+            }
+        }
+    }
+
+    template <typename K>
+    bool erase(const K& key) {
+        size_t pos = lowerBound(key);
+        if (pos == keys_.size() || comp_(key, keys_.data()[pos])) {
+            return false;
+        }
+        keys_.erase(pos);
+        return true;
+    }
+
+    const Key& operator [](size_t idx) const {
+        return keys_.data()[idx];
+    }
+
+    const Key* begin() const {
+        return keys_.data();
+    }
+    const Key* end() const {
+        return keys_.data() + keys_.size();
+    }
+
+    size_t size() const {
+        return keys_.size();
+    }
+    bool empty() const {
+        return keys_.size() == 0;
+    }
+    void clear() {
+        keys_.clear();
+    }
+
+  private:
+    Vector<Key> keys_;
+    Compare comp_;
+};
+
+template <typename Key, typename Value, typename Compare = std::less<>>
+class FlatMap {
+  public:
+    FlatMap() {}
+    FlatMap(std::initializer_list<std::pair<Key, Value>> list) {
+        insert(list.begin(), list.end());
+    }
+    template <typename It>
+    FlatMap(It first, It last) {
+        insert(first, last);
+    }
+
+    template <typename K>
+    size_t lowerBound(const K& key) const {
+        return branchlessLowerBound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    //nullptr if key is absent
+    template <typename K>
+    Value* find(const K& key) {
+        size_t pos = lowerBound(key);
+        if (pos == keys_.size() || comp_(key, keys_.data()[pos])) {
+            return nullptr;
+        }
+        return values_.data() + pos;
+    }
+    template <typename K>
+    const Value* find(const K& key) const {
+        size_t pos = lowerBound(key);
+        if (pos == keys_.size() || comp_(key, keys_.data()[pos])) {
+            return nullptr;
+        }
+        return values_.data() + pos;
+    }
+
+    template <typename K>
+    bool contains(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    Value& operator [](const Key& key) {
+        size_t pos = lowerBound(key);
+        if (pos == keys_.size() || comp_(key, keys_.data()[pos])) {
+            keys_.insert(pos, key);
+            values_.insert(pos, Value());
+        }
+        return values_.data()[pos];
+    }
+
+    bool insert(const Key& key, const Value& value) {
+        size_t pos = lowerBound(key);
+        if (pos != keys_.size() && !comp_(key, keys_.data()[pos])) {
+            return false;
+        }
+        keys_.insert(pos, key);
+        values_.insert(pos, value);
+        return true;
+    }
+
+    void insertOrAssign(const Key& key, const Value& value) {
+        size_t pos = lowerBound(key);
+        if (pos != keys_.size() && !comp_(key, keys_.data()[pos])) {
+            values_.data()[pos] = value;
+            return;
+        }
+        keys_.insert(pos, key);
+        values_.insert(pos, value);
+    }
+
+    //bulk load of pairs: sort a permutation once, keep the first of equal keys
+    //and the existing value for known keys, then merge from the back in place
+    template <typename It>
+    void insert(It first, It last) {
+        Vector<Key> batch_keys;
+        Vector<Value> batch_values;
+        for (; first != last; ++first) {
+            batch_keys.pushBack((*first).first);
+            batch_values.pushBack((*first).second);
+        }
+
+        Vector<size_t> order;
+        for (size_t i = 0; i < batch_keys.size(); ++i) {
+            order.pushBack(i);
+        }
+        const Key* bk = batch_keys.data();
+        std::stable_sort(order.data(), order.data() + order.size(), [&](size_t lhs, size_t rhs) {
+            return comp_(bk[lhs], bk[rhs]);
+        });
+
+        Vector<size_t> fresh;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const Key& key = bk[order.data()[i]];
+            if (fresh.size() > 0 && !comp_(bk[fresh.data()[fresh.size() - 1]], key)) {
+                continue;
+            }
+            if (contains(key)) {
+                continue;
+            }
+            fresh.pushBack(order.data()[i]);
+        }
+        if (fresh.size() == 0) {
+            return;
+        }
+
+        size_t old_size = keys_.size();
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            keys_.pushBack(Key());
+            values_.pushBack(Value());
+        }
+
+        Key* dk = keys_.data();
+        Value* dv = values_.data();
+        size_t i = old_size;
+        size_t j = fresh.size();
+        size_t out = old_size + fresh.size();
+        while (j > 0) {
+            size_t src = fresh.data()[j - 1];
+            --out;
+            if (i > 0 && comp_(bk[src], dk[i - 1])) {
+                --i;
+                dk[out] = std::move(dk[i]);
+                dv[out] = std::move(dv[i]);
+            } else {
+                --j;
+                dk[out] = std::move(batch_keys.data()[src]);
+                dv[out] = std::move(batch_values.data()[src]);
+            }
+        }
+    }
+
+    template <typename K>
+    bool erase(const K& key) {
+        size_t pos = lowerBound(key);
+        if (pos == keys_.size() || comp_(key, keys_.data()[pos])) {
+            return false;
+        }
+        keys_.erase(pos);
+        values_.erase(pos);
+        return true;
+    }
+
+    const Key& keyAt(size_t idx) const {
+        return keys_.data()[idx];
+    }
+    Value& valueAt(size_t idx) {
+        return values_.data()[idx];
+    }
+    const Value& valueAt(size_t idx) const {
+        return values_.data()[idx];
+    }
+
+    const Vector<Key>& keys() const {
+        return keys_;
+    }
+    const Vector<Value>& values() const {
+        return values_;
+    }
+
+    size_t size() const {
+        return keys_.size();
+    }
+    bool empty() const {
+        return keys_.size() == 0;
+    }
+    void clear() {
+        keys_.clear();
+        values_.clear();
+    }
+
+  private:
+    Vector<Key> keys_;
+    Vector<Value> values_;
+    Compare comp_;
+};
+
+} //namespace stdvector
@@ -1,5 +1,10 @@
+#pragma once
+
 #include <utility>
 #include <cstddef>
+#include <new>
+
+#include "allocator.hpp"
 
 namespace vstl {
 
@@ -18,7 +23,7 @@ class Function {
         copy_func     = reinterpret_cast<copy_conctruct_f_pointer>(CopyConctruct<Functor>);
         destruct_func = reinterpret_cast<destruct_f_pointer>(Destruct<Functor>);
 
-        object_      = operator new(sizeof(Functor));
+        object_      = stdvector::allocateBytes(sizeof(Functor));
         object_size_ = sizeof(Functor);
         
         copy_func(&func, object_);
@@ -27,7 +32,7 @@ class Function {
     Function(const Function& rhs) : object_(nullptr), call_func(rhs.call_func), copy_func(rhs.copy_func), destruct_func(rhs.destruct_func) {
         DeleteObject();
         object_size_ = rhs.object_size_;
-        object_      = operator new(object_size_);
+        object_      = stdvector::allocateBytes(object_size_);
 
         copy_func(rhs.object_, object_);
     }
@@ -41,13 +46,16 @@ class Function {
     }
 
     Function& operator=(const Function& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+        DeleteObject();
         call_func     = rhs.call_func;
         copy_func     = rhs.copy_func;
         destruct_func = rhs.destruct_func;
 
-        DeleteObject();
         object_size_ = rhs.object_size_;
-        object_      = operator new(object_size_);
+        object_      = stdvector::allocateBytes(object_size_);
 
         copy_func(rhs.object_, object_);
 
@@ -82,7 +90,7 @@ class Function {
     void DeleteObject() {
         if (object_ != nullptr) {
             destruct_func(object_);
-            operator delete(object_);
+            stdvector::deallocateBytes(object_, object_size_);
         }
     }
 
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+
+#include "string.hpp"
+
+//Hash functors for vstl hash containers
+
+namespace stdvector {
+
+//final avalanche from murmur3, low bits of the result are well mixed
+inline uint64_t hashMix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+namespace detail {
+
+inline uint64_t wyMix(uint64_t lhs, uint64_t rhs) {
+    __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+inline uint64_t read8(const unsigned char* ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, 8);
+    return value;
+}
+inline uint64_t read4(const unsigned char* ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, 4);
+    return value;
+}
+
+static constexpr uint64_t hash_secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                            0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+} //namespace detail
+
+//wyhash: 128-bit multiply-xor folding, 48 bytes per step with three
+//independent lanes for long inputs; up to 16 bytes are covered by two
+//overlapping reads and no loop. Well mixed in all bits.
+inline uint64_t hashBytes(const void* ptr, size_t len, uint64_t seed = 0) {
+    using detail::hash_secret;
+    using detail::read4;
+    using detail::read8;
+    using detail::wyMix;
+    const unsigned char* bytes = static_cast<const unsigned char*>(ptr);
+    seed ^= wyMix(seed ^ hash_secret[0], hash_secret[1]);
+    uint64_t a;
+    uint64_t b;
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t mid = (len >> 3) << 2;
+            a = (read4(bytes) << 32) | read4(bytes + mid);
+            b = (read4(bytes + len - 4) << 32) | read4(bytes + len - 4 - mid);
+        } else if (len > 0) {
+            a = (uint64_t(bytes[0]) << 16) | (uint64_t(bytes[len >> 1]) << 8) | bytes[len - 1];
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t left = len;
+        if (left > 48) {
+            uint64_t lane1 = seed;
+            uint64_t lane2 = seed;
+            do {
+                seed = wyMix(read8(bytes) ^ hash_secret[1], read8(bytes + 8) ^ seed);
+                lane1 = wyMix(read8(bytes + 16) ^ hash_secret[2], read8(bytes + 24) ^ lane1);
+                lane2 = wyMix(read8(bytes + 32) ^ hash_secret[3], read8(bytes + 40) ^ lane2);
+                bytes += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (left > 16) {
+            seed = wyMix(read8(bytes) ^ hash_secret[1], read8(bytes + 8) ^ seed);
+            bytes += 16;
+            left -= 16;
+        }
+        a = read8(bytes + left - 16);
+        b = read8(bytes + left - 8);
+    }
+    __uint128_t product = static_cast<__uint128_t>(a ^ hash_secret[1]) * (b ^ seed);
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+    return wyMix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]);
+}
+
+//folds another hash into seed, order matters
+inline uint64_t hashCombine(uint64_t seed, uint64_t hash) {
+    return detail::wyMix(seed ^ detail::hash_secret[0], hash ^ detail::hash_secret[2]);
+}
+
+template <typename T, typename = void>
+struct Hash;
+
+template <typename T>
+struct Hash<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+    uint64_t operator()(T val) const {
+        return hashMix(static_cast<uint64_t>(val));
+    }
+};
+
+template <typename T>
+struct Hash<T*> {
+    uint64_t operator()(T* ptr) const {
+        return hashMix(reinterpret_cast<uintptr_t>(ptr));
+    }
+};
+
+//transparent: C-strings and views hash the same as String with equal contents
+template <>
+struct Hash<String> {
+    using is_transparent = void;
+
+    //inline strings are hashed in place, 22 chars or less never loop
+    uint64_t operator()(const String& str) const {
+        return hashBytes(str.c_str(), str.size());
+    }
+    uint64_t operator()(const char* str) const {
+        return hashBytes(str, std::strlen(str));
+    }
+    uint64_t operator()(StringView str) const {
+        return hashBytes(str.data(), str.size());
+    }
+};
+
+template <>
+struct Hash<StringView> : Hash<String> {};
+
+template <typename First, typename Second>
+struct Hash<std::pair<First, Second>> {
+    uint64_t operator()(const std::pair<First, Second>& pair) const {
+        return hashCombine(Hash<First>()(pair.first), Hash<Second>()(pair.second));
+    }
+};
+
+//hash of several values in order, e.g. for a composite key's Hash
+template <typename T>
+uint64_t hashValues(const T& value) {
+    return Hash<T>()(value);
+}
+template <typename T, typename... Rest>
+uint64_t hashValues(const T& value, const Rest&... rest) {
+    return hashCombine(Hash<T>()(value), hashValues(rest...));
+}
+
+//String that remembers its hash. It is computed on first use and dropped
+//by every mutation, which all go through this class; hashing, lookups and
+//equality between unequal keys cost an integer compare after that.
+//Hashes and compares equal to String and StringView of the same contents.
+class HashedString {
+  public:
+    HashedString() : hash_(0) {}
+    HashedString(const char* str) : str_(str), hash_(0) {}
+    explicit HashedString(StringView str) : str_(str), hash_(0) {}
+    HashedString(const String& str) : str_(str), hash_(0) {}
+    HashedString(String&& str) : str_(std::move(str)), hash_(0) {}
+    HashedString(const HashedString& other) : str_(other.str_), hash_(other.cachedHash()) {}
+    HashedString(HashedString&& other) : str_(std::move(other.str_)), hash_(other.cachedHash()) {
+        other.hash_.store(0, std::memory_order_relaxed);
+    }
+
+    HashedString& operator=(const HashedString& other) {
+        str_ = other.str_;
+        hash_.store(other.cachedHash(), std::memory_order_relaxed);
+        return *this;
+    }
+    HashedString& operator=(HashedString&& other) {
+        str_ = std::move(other.str_);
+        hash_.store(other.cachedHash(), std::memory_order_relaxed);
+        other.hash_.store(0, std::memory_order_relaxed);
+        return *this;
+    }
+
+    const String& str() const {
+        return str_;
+    }
+    const char* data() const {
+        return str_.data();
+    }
+    const char* c_str() const {
+        return str_.data();
+    }
+    size_t size() const {
+        return str_.size();
+    }
+    operator StringView() const {
+        return StringView(str_);
+    }
+
+    //same value as Hash<String> gives for the contents
+    uint64_t hash() const {
+        uint64_t hash = cachedHash();
+        if (hash == 0) {
+            //a real hash of 0 is just never cached
+            hash = hashBytes(str_.data(), str_.size());
+            hash_.store(hash, std::memory_order_relaxed);
+        }
+        return hash;
+    }
+
+    template <typename T>
+    HashedString& operator+=(const T& rhs) {
+        str_ += rhs;
+        invalidate();
+        return *this;
+    }
+    void push_back(char ch) {
+        str_.push_back(ch);
+        invalidate();
+    }
+    void pop_back() {
+        str_.pop_back();
+        invalidate();
+    }
+    //any other change to the underlying String: func gets it by reference
+    template <typename Func>
+    void modify(Func&& func) {
+        func(str_);
+        invalidate();
+    }
+
+    friend bool operator==(const HashedString& lhs, const HashedString& rhs) {
+        uint64_t lhs_hash = lhs.cachedHash();
+        uint64_t rhs_hash = rhs.cachedHash();
+        if (lhs_hash != 0 && rhs_hash != 0 && lhs_hash != rhs_hash) {
+            return false;
+        }
+        return StringView(lhs) == StringView(rhs);
+    }
+    friend bool operator!=(const HashedString& lhs, const HashedString& rhs) {
+        return !(lhs == rhs);
+    }
+
+  private:
+    uint64_t cachedHash() const {
+        return hash_.load(std::memory_order_relaxed);
+    }
+    void invalidate() {
+        hash_.store(0, std::memory_order_relaxed);
+    }
+
+    String str_;
+    //relaxed atomic: concurrent readers may all fill it with the same value
+    mutable std::atomic<uint64_t> hash_;
+};
+
+//transparent like Hash<String>, a HashMap<HashedString, V> can be probed
+//with a StringView or a C-string
+template <>
+struct Hash<HashedString> : Hash<String> {
+    using Hash<String>::operator();
+
+    uint64_t operator()(const HashedString& str) const {
+        return str.hash();
+    }
+};
+
+} //namespace stdvector
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <functional>
+#include <new>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "allocator.hpp"
+#include "hash.hpp"
+
+//Open addressing hash map in the style of Swiss tables: one control byte
+//per slot holding 7 bits of the hash, scanned 16 slots at a time.
+//Probing is linear, so erase shifts the run back instead of leaving
+//tombstones and lookups never slow down after many deletions. Each slot
+//also keeps the hash bits that pick its home, so neither erase nor rehash
+//calls the hasher again.
+
+namespace stdvector {
+
+class HashGroup {
+  public:
+    static const size_t width = 16;
+    static const uint8_t empty = 0x80;
+
+    explicit HashGroup(const uint8_t* ctrl) {
+#ifdef __SSE2__
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        std::memcpy(ctrl_, ctrl, width);
+#endif
+    }
+
+    //bit i is set if slot i holds h2
+    uint32_t match(uint8_t h2) const {
+#ifdef __SSE2__
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), ctrl_)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < width; ++i) {
+            mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+        }
+        return mask;
+#endif
+    }
+
+    //empty is the only control value with the high bit set
+    uint32_t matchEmpty() const {
+#ifdef __SSE2__
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < width; ++i) {
+            mask |= static_cast<uint32_t>(ctrl_[i] >> 7) << i;
+        }
+        return mask;
+#endif
+    }
+
+  private:
+#ifdef __SSE2__
+    __m128i ctrl_;
+#else
+    uint8_t ctrl_[width];
+#endif
+};
+
+template <typename Key, typename Value, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>>
+class HashMap {
+  public:
+    //keys are const outside the map, rewriting one would break its probe run
+    using Slot = std::pair<const Key, Value>;
+
+    HashMap() : ctrl_(nullptr), slots_(nullptr), homes_(nullptr), capacity_(0), size_(0) {}
+    explicit HashMap(size_t count) : HashMap() {
+        reserve(count);
+    }
+    HashMap(const HashMap& other) : HashMap() {
+        reserve(other.size_);
+        for (size_t i = 0; i < other.capacity_; ++i) {
+            if (other.isFull(i)) {
+                insert(other.slots_[i].first, other.slots_[i].second);
+            }
+        }
+    }
+    HashMap(HashMap&& other) : HashMap() {
+        swap(other);
+    }
+    ~HashMap() {
+        clear();
+        freeTable(ctrl_, slots_, homes_, capacity_);
+    }
+
+    HashMap& operator=(HashMap other) {
+        swap(other);
+        return *this;
+    }
+
+    void swap(HashMap& other) {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(homes_, other.homes_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(hasher_, other.hasher_);
+        std::swap(equal_, other.equal_);
+    }
+
+    template <bool IsConst>
+    class BasicIterator {
+      public:
+        using value_type = Slot;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const Slot*, Slot*>;
+        using reference  = std::conditional_t<IsConst, const Slot&, Slot&>;
+        using iterator_category = std::forward_iterator_tag;
+        using MapPointer = std::conditional_t<IsConst, const HashMap*, HashMap*>;
+
+        BasicIterator() : map_(nullptr), pos_(0) {}
+        BasicIterator(MapPointer map, size_t start_pos) : map_(map), pos_(start_pos) {
+            skipEmpty();
+        }
+        //iterator -> const iterator
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) : map_(other.map_), pos_(other.pos_) {}
+
+        reference operator*() const {
+            return map_->slots_[pos_];
+        }
+        pointer operator->() const {
+            return map_->slots_ + pos_;
+        }
+
+        BasicIterator& operator++() {
+            ++pos_;
+            skipEmpty();
+            return *this;
+        }
+        BasicIterator operator++(int) {
+            BasicIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator!=(const BasicIterator &it) const {
+            return pos_ != it.pos_;
+        }
+        bool operator==(const BasicIterator &it) const {
+            return pos_ == it.pos_;
+        }
+
+      private:
+        friend class BasicIterator<!IsConst>;
+
+        void skipEmpty() {
+            while (pos_ < map_->capacity_ && !map_->isFull(pos_)) {
+                ++pos_;
+            }
+        }
+
+        MapPointer map_;
+        size_t pos_;
+    };
+
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    Iterator begin() {
+        return Iterator(this, 0);
+    }
+    Iterator end() {
+        return Iterator(this, capacity_);
+    }
+    ConstIterator begin() const {
+        return ConstIterator(this, 0);
+    }
+    ConstIterator end() const {
+        return ConstIterator(this, capacity_);
+    }
+
+    //nullptr if key is absent
+    template <typename K>
+    Value* find(const K& key) {
+        return findHashed(key, hasher_(key));
+    }
+    template <typename K>
+    const Value* find(const K& key) const {
+        return findHashed(key, hasher_(key));
+    }
+
+    template <typename K>
+    bool contains(const K& key) const {
+        return containsHashed(key, hasher_(key));
+    }
+
+    bool insert(const Key& key, const Value& value) {
+        return insertHashed(key, value, hasher_(key));
+    }
+
+    void insertOrAssign(const Key& key, const Value& value) {
+        insertOrAssignHashed(key, value, hasher_(key));
+    }
+
+    Value& operator [](const Key& key) {
+        uint64_t hash = hasher_(key);
+        size_t idx = findIndex(key, hash);
+        if (idx == npos) {
+            idx = emplaceNew(hash, key, Value());
+        }
+        return slots_[idx].second;
+    }
+
+    template <typename K>
+    bool erase(const K& key) {
+        return eraseHashed(key, hasher_(key));
+    }
+
+    //the same operations for a caller that already hashed key with an
+    //equal Hasher, e.g. to pick a shard
+    template <typename K>
+    Value* findHashed(const K& key, uint64_t hash) {
+        size_t idx = findIndex(key, hash);
+        return idx == npos ? nullptr : &slots_[idx].second;
+    }
+    template <typename K>
+    const Value* findHashed(const K& key, uint64_t hash) const {
+        size_t idx = findIndex(key, hash);
+        return idx == npos ? nullptr : &slots_[idx].second;
+    }
+
+    template <typename K>
+    bool containsHashed(const K& key, uint64_t hash) const {
+        return findIndex(key, hash) != npos;
+    }
+
+    bool insertHashed(const Key& key, const Value& value, uint64_t hash) {
+        if (findIndex(key, hash) != npos) {
+            return false;
+        }
+        emplaceNew(hash, key, value);
+        return true;
+    }
+
+    void insertOrAssignHashed(const Key& key, const Value& value, uint64_t hash) {
+        size_t idx = findIndex(key, hash);
+        if (idx != npos) {
+            slots_[idx].second = value;
+            return;
+        }
+        emplaceNew(hash, key, value);
+    }
+
+    template <typename K>
+    bool eraseHashed(const K& key, uint64_t hash) {
+        size_t idx = findIndex(key, hash);
+        if (idx == npos) {
+            return false;
+        }
+        eraseAt(idx);
+        return true;
+    }
+
+    //makes room for count elements without further rehashing
+    void reserve(size_t count) {
+        size_t new_capacity = HashGroup::width;
+        while (new_capacity - new_capacity / 8 < count) {
+            new_capacity *= 2;
+        }
+        if (new_capacity > capacity_) {
+            rehash(new_capacity);
+        }
+    }
+
+    //rebuilds the table with at least count slots (rounded to a power of two)
+    void rehash(size_t count) {
+        size_t new_capacity = HashGroup::width;
+        while (new_capacity < count || new_capacity - new_capacity / 8 < size_) {
+            new_capacity *= 2;
+        }
+
+        uint8_t* old_ctrl = ctrl_;
+        Slot* old_slots = slots_;
+        uint32_t* old_homes = homes_;
+        size_t old_capacity = capacity_;
+
+        capacity_ = new_capacity;
+        ctrl_ = static_cast<uint8_t*>(allocateBytes(capacity_ + HashGroup::width - 1));
+        std::memset(ctrl_, HashGroup::empty, capacity_ + HashGroup::width - 1);
+        slots_ = static_cast<Slot*>(allocateBytes(capacity_ * sizeof(Slot), alignof(Slot)));
+        homes_ = static_cast<uint32_t*>(allocateBytes(capacity_ * sizeof(uint32_t)));
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!(old_ctrl[i] & HashGroup::empty)) {
+                size_t idx = findEmpty(old_homes[i]);
+                relocate(slots_ + idx, old_slots + i);
+                setCtrl(idx, old_ctrl[i]);
+                homes_[idx] = old_homes[i];
+            }
+        }
+
+        freeTable(old_ctrl, old_slots, old_homes, old_capacity);
+    }
+
+    void clear() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (isFull(i)) {
+                slots_[i].~Slot();
+            }
+        }
+        if (ctrl_ != nullptr) {
+            std::memset(ctrl_, HashGroup::empty, capacity_ + HashGroup::width - 1);
+        }
+        size_ = 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+    size_t capacity() const {
+        return capacity_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+  private:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    static uint8_t h2(uint64_t hash) {
+        return static_cast<uint8_t>(hash & 0x7f);
+    }
+    //past 2^32 slots only the low ones serve as homes, probing still works
+    static uint32_t homeBits(uint64_t hash) {
+        return static_cast<uint32_t>(hash >> 7);
+    }
+    size_t home(uint32_t bits) const {
+        return static_cast<size_t>(bits) & (capacity_ - 1);
+    }
+
+    static void freeTable(uint8_t* ctrl, Slot* slots, uint32_t* homes, size_t capacity) {
+        if (ctrl != nullptr) {
+            deallocateBytes(ctrl, capacity + HashGroup::width - 1);
+            deallocateBytes(slots, capacity * sizeof(Slot), alignof(Slot));
+            deallocateBytes(homes, capacity * sizeof(uint32_t));
+        }
+    }
+
+    //moving the const key out is fine, the source slot dies right after
+    static void relocate(Slot* dst, Slot* src) {
+        new(dst) Slot(std::move(const_cast<Key&>(src->first)), std::move(src->second));
+        src->~Slot();
+    }
+
+    bool isFull(size_t idx) const {
+        return !(ctrl_[idx] & HashGroup::empty);
+    }
+
+    //first width - 1 control bytes are mirrored past the end, so a group
+    //load at any slot sees the wrapped-around bytes
+    void setCtrl(size_t idx, uint8_t val) {
+        ctrl_[idx] = val;
+        if (idx < HashGroup::width - 1) {
+            ctrl_[capacity_ + idx] = val;
+        }
+    }
+
+    template <typename K>
+    size_t findIndex(const K& key, uint64_t hash) const {
+        if (capacity_ == 0) {
+            return npos;
+        }
+        size_t mask = capacity_ - 1;
+        size_t pos = home(homeBits(hash));
+        for (size_t probed = 0; probed < capacity_; probed += HashGroup::width) {
+            HashGroup group(ctrl_ + pos);
+            for (uint32_t match = group.match(h2(hash)); match != 0; match &= match - 1) {
+                size_t idx = (pos + __builtin_ctz(match)) & mask;
+                if (equal_(slots_[idx].first, key)) {
+                    return idx;
+                }
+            }
+            if (group.matchEmpty() != 0) {
+                return npos;
+            }
+            pos = (pos + HashGroup::width) & mask;
+        }
+        return npos;
+    }
+
+    size_t findEmpty(uint32_t home_bits) const {
+        size_t mask = capacity_ - 1;
+        size_t pos = home(home_bits);
+        while (true) {
+            uint32_t empties = HashGroup(ctrl_ + pos).matchEmpty();
+            if (empties != 0) {
+                return (pos + __builtin_ctz(empties)) & mask;
+            }
+            pos = (pos + HashGroup::width) & mask;
+        }
+    }
+
+    template <typename V>
+    size_t emplaceNew(uint64_t hash, const Key& key, V&& value) {
+        if (size_ + 1 > capacity_ - capacity_ / 8) {
+            //key or value may sit in a slot, build the entry before rehash frees it
+            Slot fresh(key, std::forward<V>(value));
+            rehash(capacity_ == 0 ? HashGroup::width : capacity_ * 2);
+            return placeNew(hash, std::move(const_cast<Key&>(fresh.first)), std::move(fresh.second));
+        }
+        return placeNew(hash, key, std::forward<V>(value));
+    }
+
+    //room is there; the control byte is set only once the slot is built
+    template <typename K, typename V>
+    size_t placeNew(uint64_t hash, K&& key, V&& value) {
+        size_t idx = findEmpty(homeBits(hash));
+        new(slots_ + idx) Slot(std::forward<K>(key), std::forward<V>(value));
+        setCtrl(idx, h2(hash));
+        homes_[idx] = homeBits(hash);
+        ++size_;
+        return idx;
+    }
+
+    //backward shift: pull later members of the run into the hole as long
+    //as that does not move them before their home slot
+    void eraseAt(size_t idx) {
+        size_t mask = capacity_ - 1;
+        slots_[idx].~Slot();
+
+        size_t hole = idx;
+        for (size_t next = (idx + 1) & mask; isFull(next); next = (next + 1) & mask) {
+            size_t next_home = home(homes_[next]);
+            if (((next - next_home) & mask) >= ((next - hole) & mask)) {
+                relocate(slots_ + hole, slots_ + next);
+                setCtrl(hole, ctrl_[next]);
+                homes_[hole] = homes_[next];
+                hole = next;
+            }
+        }
+        setCtrl(hole, HashGroup::empty);
+        --size_;
+    }
+
+    uint8_t* ctrl_;      //capacity_ + width - 1 control bytes
+    Slot* slots_;        //raw storage, only slots with full control byte are constructed
+    uint32_t* homes_;    //homeBits of each full slot
+    size_t capacity_;    //power of two or 0
+    size_t size_;
+    Hasher hasher_;
+    KeyEqual equal_;
+};
+
+} //namespace stdvector
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+#include <shared_mutex>
+#include <mutex>
+
+#include "hash.hpp"
+#include "hash_map.hpp"
+#include "allocator.hpp"
+#include "string_view.hpp"
+#include "vector2.hpp"
+
+//String interning: every distinct content is stored once in an arena and
+//named by a 32-bit id, so equal strings from one pool have equal ids and
+//compare and hash as integers. Arena memory lives as long as the pool and
+//never moves, handles can be copied around freely meanwhile.
+
+namespace stdvector {
+
+//Handle to an interned string: the id plus a pointer to its characters,
+//which are null terminated and preceded by their 32-bit length.
+class InternedString {
+  public:
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    //the empty string, not owned by any pool: unequal to every pooled
+    //handle, an interned "" included. No pool ever gives out npos.
+    InternedString() : id_(npos), str_(emptyRecord() + sizeof(uint32_t)) {}
+
+    uint32_t id() const {
+        return id_;
+    }
+    const char* c_str() const {
+        return str_;
+    }
+    size_t size() const {
+        uint32_t len;
+        std::memcpy(&len, str_ - sizeof(uint32_t), sizeof(uint32_t));
+        return len;
+    }
+
+    operator StringView() const {
+        return StringView(str_, size());
+    }
+
+    //only meaningful between handles of the same pool
+    bool operator==(const InternedString& other) const {
+        return id_ == other.id_;
+    }
+    bool operator!=(const InternedString& other) const {
+        return id_ != other.id_;
+    }
+    //orders by id, not by content
+    bool operator<(const InternedString& other) const {
+        return id_ < other.id_;
+    }
+
+  private:
+    friend class InternPool;
+
+    InternedString(uint32_t id, const char* str) : id_(id), str_(str) {}
+
+    static const char* emptyRecord() {
+        alignas(uint32_t) static const char record[sizeof(uint32_t) + 1] = {};
+        return record;
+    }
+
+    uint32_t id_;
+    const char* str_;
+};
+
+template <>
+struct Hash<InternedString> {
+    uint64_t operator()(const InternedString& str) const {
+        return hashMix(str.id());
+    }
+};
+
+//Thread safe: contents are spread over shards by hash, each with its own
+//lock, arena and id sequence; the low id bits name the shard. Lookups of
+//known strings only take the shard lock shared.
+class InternPool {
+  public:
+    //shard_count is rounded up to a power of two, at most 2^31 so that ids
+    //keep bits for the per shard sequence
+    explicit InternPool(size_t shard_count = 16) : shard_bits_(0) {
+        while ((size_t(1) << shard_bits_) < shard_count) {
+            ++shard_bits_;
+        }
+        if (shard_bits_ >= 32) {
+            throw std::invalid_argument("InternPool: too many shards");
+        }
+        shards_ = new Shard[size_t(1) << shard_bits_];
+    }
+    InternPool(const InternPool&) = delete;
+    ~InternPool() {
+        delete[] shards_;
+    }
+
+    InternPool& operator=(const InternPool&) = delete;
+
+    InternedString intern(StringView str) {
+        uint64_t hash = hasher_(str);
+        Shard& shard = shards_[shardIndex(hash)];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            const uint32_t* id = shard.ids.find(str);
+            if (id != nullptr) {
+                return handle(*id);
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return insertLocked(shard, shardIndex(hash), str);
+    }
+
+    //lookup only, nothing is added
+    bool find(StringView str, InternedString& out) const {
+        const Shard& shard = shards_[shardIndex(hasher_(str))];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const uint32_t* id = shard.ids.find(str);
+        if (id == nullptr) {
+            return false;
+        }
+        out = handle(*id);
+        return true;
+    }
+
+    //handle for an id this pool gave out
+    InternedString get(uint32_t id) const {
+        std::shared_lock<std::shared_mutex> lock(shards_[id & (shardCount() - 1)].mutex);
+        return handle(id);
+    }
+
+    //interns count strings into out, taking every shard lock once
+    template <typename Str>
+    void internAll(const Str* values, size_t count, InternedString* out) {
+        Vector<uint32_t> order(count);
+        Vector<size_t> starts(shardCount() + 1);
+        Vector<uint32_t> shard_of(count);
+        for (size_t i = 0; i < count; ++i) {
+            shard_of.data()[i] = static_cast<uint32_t>(shardIndex(hasher_(StringView(values[i]))));
+            ++starts.data()[shard_of.data()[i] + 1];
+        }
+        for (size_t s = 0; s < shardCount(); ++s) {
+            starts.data()[s + 1] += starts.data()[s];
+        }
+        for (size_t i = 0; i < count; ++i) {
+            order.data()[starts.data()[shard_of.data()[i]]++] = static_cast<uint32_t>(i);
+        }
+        size_t begin = 0;
+        for (size_t s = 0; s < shardCount(); ++s) {
+            size_t end = starts.data()[s];
+            if (begin == end) {
+                continue;
+            }
+            Shard& shard = shards_[s];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (size_t k = begin; k < end; ++k) {
+                uint32_t i = order.data()[k];
+                out[i] = insertLocked(shard, s, StringView(values[i]));
+            }
+            begin = end;
+        }
+    }
+
+    Vector<InternedString> internAll(const Vector<String>& column) {
+        Vector<InternedString> result(column.size());
+        internAll(column.data(), column.size(), result.data());
+        return result;
+    }
+
+    //not a snapshot: shards are counted one after another
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount(); ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+            total += shards_[i].records.size();
+        }
+        return total;
+    }
+
+    size_t shardCount() const {
+        return size_t(1) << shard_bits_;
+    }
+
+  private:
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    //own cache line per shard so neighbouring locks do not false share
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        HashMap<StringView, uint32_t> ids;   //keys point into the arena
+        Vector<const char*> records;         //local index -> characters
+        Vector<Chunk> chunks;                //for freeing
+        char* current = nullptr;             //chunk small records are cut from
+        size_t used = chunk_size;            //bytes taken in it
+
+        ~Shard() {
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                deallocateBytes(chunks.data()[i].data, chunks.data()[i].size);
+            }
+        }
+
+        //length prefixed, null terminated copy; big strings get their own chunk
+        const char* store(StringView str) {
+            size_t bytes = (sizeof(uint32_t) + str.size() + 1 + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
+            char* record;
+            if (bytes > chunk_size / 4) {
+                record = static_cast<char*>(allocateBytes(bytes));
+                chunks.pushBack(Chunk{record, bytes});
+            } else {
+                if (used + bytes > chunk_size) {
+                    current = static_cast<char*>(allocateBytes(chunk_size));
+                    chunks.pushBack(Chunk{current, chunk_size});
+                    used = 0;
+                }
+                record = current + used;
+                used += bytes;
+            }
+            uint32_t len = static_cast<uint32_t>(str.size());
+            std::memcpy(record, &len, sizeof(uint32_t));
+            if (str.size() > 0) {
+                std::memcpy(record + sizeof(uint32_t), str.data(), str.size());
+            }
+            record[sizeof(uint32_t) + str.size()] = '\0';
+            return record + sizeof(uint32_t);
+        }
+    };
+
+    //top hash bits pick the shard, HashMap itself uses the low ones
+    size_t shardIndex(uint64_t hash) const {
+        if (shard_bits_ == 0) {
+            return 0;
+        }
+        return static_cast<size_t>(hash >> (64 - shard_bits_));
+    }
+
+    //shard lock held
+    InternedString handle(uint32_t id) const {
+        const Shard& shard = shards_[id & (shardCount() - 1)];
+        return InternedString(id, shard.records.data()[id >> shard_bits_]);
+    }
+
+    //unique lock held
+    InternedString insertLocked(Shard& shard, size_t shard_idx, StringView str) {
+        const uint32_t* found = shard.ids.find(str);
+        if (found != nullptr) {
+            return InternedString(*found, shard.records.data()[*found >> shard_bits_]);
+        }
+        //a shard holds 2^(32 - shard_bits_) ids, past that they would repeat;
+        //the last one is kept back, in the top shard it would be npos
+        if (shard.records.size() >= (size_t(1) << (32 - shard_bits_)) - 1) {
+            throw std::overflow_error("InternPool: shard is out of ids");
+        }
+        //records keep a 32 bit length prefix
+        if (str.size() > UINT32_MAX) {
+            throw std::length_error("InternPool: string is too long");
+        }
+        const char* chars = shard.store(str);
+        uint32_t id = static_cast<uint32_t>((shard.records.size() << shard_bits_) | shard_idx);
+        shard.records.pushBack(chars);
+        shard.ids.insert(StringView(chars, str.size()), id);
+        return InternedString(id, chars);
+    }
+
+    Shard* shards_;
+    size_t shard_bits_;
+    Hash<StringView> hasher_;
+};
+
+} //namespace stdvector
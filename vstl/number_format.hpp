@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#include "string_view.hpp"
+
+//Number <-> text kernels used by String::append* and the parse functions.
+//Integers are written two digits at a time from a table and parsed eight
+//digits at a time with SWAR arithmetic. Doubles go through std::to_chars /
+//std::from_chars where the library has them (shortest round trip output,
+//Ryu based in current libraries), snprintf/strtod otherwise.
+
+namespace stdvector {
+
+//longest output of each writer, sizes of the tail String reserves
+static constexpr size_t max_int_chars = 20;
+static constexpr size_t max_hex_chars = 16;
+static constexpr size_t max_double_chars = 32;
+//fixed notation: sign, 309 integer digits, point, the precision digits
+//and snprintf's \0; precision is clamped to 0..max_fixed_precision
+static constexpr int max_fixed_precision = 64;
+static constexpr size_t max_fixed_chars = 312 + max_fixed_precision;
+
+//compiler builtins where there are any, portable versions otherwise
+inline unsigned leadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return value == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned count = 0;
+    for (uint64_t bit = uint64_t(1) << 63; bit != 0 && (value & bit) == 0; bit >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+//both return true when the exact result does not fit
+inline bool mulOverflow(uint64_t lhs, uint64_t rhs, uint64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(lhs, rhs, &out);
+#else
+    out = lhs * rhs;
+    return lhs != 0 && out / lhs != rhs;
+#endif
+}
+inline bool addOverflow(uint64_t lhs, uint64_t rhs, uint64_t& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(lhs, rhs, &out);
+#else
+    out = lhs + rhs;
+    return out < lhs;
+#endif
+}
+
+inline const char* digitPairs() {
+    return "00010203040506070809"
+           "10111213141516171819"
+           "20212223242526272829"
+           "30313233343536373839"
+           "40414243444546474849"
+           "50515253545556575859"
+           "60616263646566676869"
+           "70717273747576777879"
+           "80818283848586878889"
+           "90919293949596979899";
+}
+
+inline size_t decimalDigits(uint64_t value) {
+    size_t digits = 1;
+    for (uint64_t bound = 10; digits < max_int_chars && value >= bound; bound *= 10) {
+        ++digits;
+    }
+    return digits;
+}
+
+//writes exactly digits chars (zero padded on the left), returns the end
+inline char* writeDecimal(char* dst, uint64_t value, size_t digits) {
+    char* pos = dst + digits;
+    const char* pairs = digitPairs();
+    while (value >= 100) {
+        pos -= 2;
+        std::memcpy(pos, pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        pos -= 2;
+        std::memcpy(pos, pairs + value * 2, 2);
+    } else {
+        *--pos = static_cast<char>('0' + value);
+    }
+    while (pos > dst) {
+        *--pos = '0';
+    }
+    return dst + digits;
+}
+
+inline char* writeUInt(char* dst, uint64_t value, size_t min_width = 0) {
+    size_t digits = decimalDigits(value);
+    return writeDecimal(dst, value, digits > min_width ? digits : min_width);
+}
+
+//the sign does not count towards min_width
+inline char* writeInt(char* dst, int64_t value, size_t min_width = 0) {
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if (value < 0) {
+        *dst++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    return writeUInt(dst, magnitude, min_width);
+}
+
+inline size_t hexDigits(uint64_t value) {
+    return value == 0 ? 1 : (67 - leadingZeros(value)) / 4;
+}
+
+inline char* writeHex(char* dst, uint64_t value, size_t min_width = 0, bool upper = false) {
+    const char* alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    size_t digits = hexDigits(value);
+    if (digits < min_width) {
+        digits = min_width;
+    }
+    for (size_t i = digits; i-- > 0;) {
+        dst[i] = alphabet[value & 15];
+        value >>= 4;
+    }
+    return dst + digits;
+}
+
+//shortest text that reads back as the same double
+inline char* writeDouble(char* dst, double value) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(dst, dst + max_double_chars, value).ptr;
+#else
+    return dst + std::snprintf(dst, max_double_chars, "%.17g", value);
+#endif
+}
+
+//precision digits after the point; dst needs max_fixed_chars
+inline char* writeFixed(char* dst, double value, int precision) {
+    precision = precision < 0 ? 0 : (precision > max_fixed_precision ? max_fixed_precision : precision);
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(dst, dst + max_fixed_chars, value, std::chars_format::fixed, precision).ptr;
+#else
+    return dst + std::snprintf(dst, max_fixed_chars, "%.*f", precision, value);
+#endif
+}
+
+//eight ASCII digits loaded little endian
+inline bool isEightDigits(uint64_t chunk) {
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+inline uint32_t parseEightDigits(uint64_t chunk) {
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    chunk = (chunk & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return static_cast<uint32_t>((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+
+//The parsers return how many chars they consumed, 0 when str does not
+//start with a number or it does not fit; out is only written on success.
+
+inline size_t parseUInt(StringView str, uint64_t& out) {
+    const char* data = str.data();
+    size_t len = str.size();
+    size_t pos = 0;
+    uint64_t value = 0;
+    bool overflow = false;
+    uint64_t chunk;
+    while (pos + 8 <= len && (std::memcpy(&chunk, data + pos, 8), isEightDigits(chunk))) {
+        overflow |= mulOverflow(value, 100000000ULL, value);
+        overflow |= addOverflow(value, parseEightDigits(chunk), value);
+        pos += 8;
+    }
+    for (; pos < len && static_cast<unsigned char>(data[pos] - '0') < 10; ++pos) {
+        overflow |= mulOverflow(value, 10ULL, value);
+        overflow |= addOverflow(value, static_cast<uint64_t>(data[pos] - '0'), value);
+    }
+    if (pos == 0 || overflow) {
+        return 0;
+    }
+    out = value;
+    return pos;
+}
+
+//optional sign, then digits
+inline size_t parseInt(StringView str, int64_t& out) {
+    bool negative = str.size() > 0 && str[0] == '-';
+    size_t sign = str.size() > 0 && (str[0] == '-' || str[0] == '+') ? 1 : 0;
+    uint64_t magnitude;
+    size_t digits = parseUInt(str.substr(sign), magnitude);
+    if (digits == 0) {
+        return 0;
+    }
+    uint64_t limit = negative ? uint64_t(1) << 63 : (uint64_t(1) << 63) - 1;
+    if (magnitude > limit) {
+        return 0;
+    }
+    out = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return sign + digits;
+}
+
+//hex digits of either case, no 0x prefix; leading zeros do not count
+//towards the 16 digits that fit
+inline size_t parseHex(StringView str, uint64_t& out) {
+    uint64_t value = 0;
+    size_t pos = 0;
+    while (pos < str.size() && str[pos] == '0') {
+        ++pos;
+    }
+    size_t first_significant = pos;
+    for (; pos < str.size(); ++pos) {
+        unsigned ch = static_cast<unsigned char>(str[pos]);
+        unsigned digit;
+        if (ch - '0' < 10u) {
+            digit = ch - '0';
+        } else if ((ch | 0x20) - 'a' < 6u) {
+            digit = (ch | 0x20) - 'a' + 10;
+        } else {
+            break;
+        }
+        if (pos - first_significant == max_hex_chars) {
+            return 0;
+        }
+        value = (value << 4) | digit;
+    }
+    if (pos == 0) {
+        return 0;
+    }
+    out = value;
+    return pos;
+}
+
+inline size_t parseDouble(StringView str, double& out) {
+#if defined(__cpp_lib_to_chars)
+    //from_chars takes no leading '+'
+    size_t sign = str.size() > 1 && str[0] == '+' && str[1] != '-' ? 1 : 0;
+    double value;
+    std::from_chars_result res = std::from_chars(str.data() + sign, str.data() + str.size(), value);
+    if (res.ec != std::errc()) {
+        return 0;
+    }
+    out = value;
+    return res.ptr - str.data();
+#else
+    char buf[64];
+    size_t len = str.size() < sizeof(buf) - 1 ? str.size() : sizeof(buf) - 1;
+    std::memcpy(buf, str.data(), len);
+    buf[len] = '\0';
+    char* end;
+    double value = std::strtod(buf, &end);
+    if (end == buf) {
+        return 0;
+    }
+    out = value;
+    return end - buf;
+#endif
+}
+
+} //namespace stdvector
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <utility>
+
+//Fixed size block pools. Blocks are carved from large slabs and recycled
+//through intrusive free lists: every thread keeps a small cache it can use
+//without locking and trades whole batches with the shared list when the
+//cache runs dry or overflows. Slabs are never handed back to the system.
+
+namespace stdvector {
+
+//snapshot of one pool; blocks inside thread caches count as outstanding
+struct PoolStats {
+    size_t block_size;
+    size_t reserved_bytes;   //slabs taken from the system
+    size_t central_free;     //blocks on the shared free list
+    size_t outstanding;      //blocks in use or cached by threads
+    size_t refills;          //batches moved to thread caches
+    size_t releases;         //batches given back
+};
+
+//one pool per (Size, Align), shared by every type that maps to it
+template <size_t Size, size_t Align = alignof(std::max_align_t)>
+class FixedPool {
+    static_assert((Align & (Align - 1)) == 0, "alignment must be a power of two");
+
+  public:
+    static constexpr size_t align = Align < alignof(void*) ? alignof(void*) : Align;
+    static constexpr size_t min_size = Size < sizeof(void*) ? sizeof(void*) : Size;
+    static constexpr size_t block_size = (min_size + align - 1) / align * align;
+    //big blocks travel in smaller batches so idle caches hold less memory
+    static constexpr size_t batch = 8192 / block_size < 2 ? 2 : (8192 / block_size > 32 ? 32 : 8192 / block_size);
+    static constexpr size_t slab_size = block_size * 8 < 64 * 1024 ? 64 * 1024 : block_size * 8;
+
+    static void* allocate() {
+        Cache& cache = localCache();
+        if (cache.head == nullptr) {
+            if (cache.dead) {
+                return global().take();
+            }
+            refill(cache);
+        }
+        Node* node = cache.head;
+        cache.head = node->next;
+        --cache.count;
+        return node;
+    }
+
+    static void deallocate(void* ptr) {
+        Cache& cache = localCache();
+        if (cache.dead) {
+            global().give(static_cast<Node*>(ptr));
+            return;
+        }
+        Node* node = static_cast<Node*>(ptr);
+        node->next = cache.head;
+        cache.head = node;
+        if (++cache.count > 2 * batch) {
+            release(cache, batch);
+        }
+    }
+
+    static PoolStats stats() {
+        Global& pool = global();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        return PoolStats{block_size, pool.slabs * slab_size, pool.free_count,
+                         pool.slabs * (slab_size / block_size) - pool.slab_left - pool.free_count,
+                         pool.refills, pool.releases};
+    }
+
+  private:
+    struct Node {
+        Node* next;
+    };
+
+    struct Global {
+        std::mutex mutex;
+        Node* free = nullptr;
+        unsigned char* slab = nullptr;
+        size_t slab_left = 0;
+        size_t free_count = 0;
+        size_t slabs = 0;
+        size_t refills = 0;
+        size_t releases = 0;
+
+        //lock held
+        Node* carve() {
+            if (slab_left == 0) {
+                slab = static_cast<unsigned char*>(::operator new(slab_size, std::align_val_t(align)));
+                slab_left = slab_size / block_size;
+                ++slabs;
+            }
+            --slab_left;
+            return reinterpret_cast<Node*>(slab + slab_left * block_size);
+        }
+
+        Node* take() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (free == nullptr) {
+                return carve();
+            }
+            Node* node = free;
+            free = node->next;
+            --free_count;
+            return node;
+        }
+
+        void give(Node* node) {
+            std::lock_guard<std::mutex> lock(mutex);
+            node->next = free;
+            free = node;
+            ++free_count;
+        }
+    };
+
+    //trivially destructible so it stays usable while the thread exits;
+    //the flusher below empties it and marks it dead
+    struct Cache {
+        Node* head;
+        size_t count;
+        bool registered;
+        bool dead;
+    };
+
+    struct CacheFlusher {
+        ~CacheFlusher() {
+            Cache& cache = localCache();
+            if (cache.head != nullptr) {
+                release(cache, cache.count);
+            }
+            cache.dead = true;
+        }
+    };
+
+    static Global& global() {
+        //leaked on purpose: blocks may be freed by static destructors
+        static Global* pool = new Global();
+        return *pool;
+    }
+
+    //the flusher is registered on first use, whether that is an allocate
+    //or a deallocate: a thread that only frees still returns its cache
+    static Cache& localCache() {
+        static thread_local Cache cache = {nullptr, 0, false, false};
+        if (!cache.registered) {
+            cache.registered = true;
+            static thread_local CacheFlusher flusher;
+            (void)flusher;
+        }
+        return cache;
+    }
+
+    static void refill(Cache& cache) {
+        Global& pool = global();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        ++pool.refills;
+        while (cache.count < batch) {
+            Node* node;
+            if (pool.free != nullptr) {
+                node = pool.free;
+                pool.free = node->next;
+                --pool.free_count;
+            } else {
+                node = pool.carve();
+            }
+            node->next = cache.head;
+            cache.head = node;
+            ++cache.count;
+        }
+    }
+
+    //hands the first count cached blocks back to the shared list
+    static void release(Cache& cache, size_t count) {
+        Node* first = cache.head;
+        Node* last = first;
+        for (size_t i = 1; i < count; ++i) {
+            last = last->next;
+        }
+        cache.head = last->next;
+        cache.count -= count;
+        Global& pool = global();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        last->next = pool.free;
+        pool.free = first;
+        pool.free_count += count;
+        ++pool.releases;
+    }
+};
+
+//typed front end for node based containers
+template <typename T>
+class ObjectPool {
+  public:
+    using Pool = FixedPool<sizeof(T), alignof(T)>;
+
+    static void* allocate() {
+        return Pool::allocate();
+    }
+    static void deallocate(void* ptr) {
+        Pool::deallocate(ptr);
+    }
+
+    template <typename... Args>
+    static T* create(Args&&... args) {
+        void* ptr = Pool::allocate();
+        try {
+            return new(ptr) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Pool::deallocate(ptr);
+            throw;
+        }
+    }
+    static void destroy(T* ptr) {
+        ptr->~T();
+        Pool::deallocate(ptr);
+    }
+};
+
+//std style allocator: single objects come from the pool, arrays from new
+template <typename T>
+class PoolAllocator {
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = PoolAllocator<U>;
+    };
+
+    PoolAllocator() {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        if (count == 1) {
+            return static_cast<T*>(ObjectPool<T>::allocate());
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    void deallocate(T* ptr, size_t count) {
+        if (count == 1) {
+            ObjectPool<T>::deallocate(ptr);
+        } else {
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const {
+        return false;
+    }
+};
+
+} //namespace stdvector
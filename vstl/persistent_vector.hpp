@@ -0,0 +1,272 @@
+#pragma once
+
+#include <utility>
+
+#include "smart_ptr.hpp"
+
+//Immutable vector with structural sharing: a 32-way radix tree whose nodes
+//are reference counted by SharedPtr. Updates copy the path to one leaf
+//(O(log32 n)) and share everything else with the previous version, so
+//versions are cheap to keep and safe to hand to other threads.
+//The last, partially filled leaf is kept aside as the tail to make
+//pushBack touch the tree only once every 32 elements.
+
+namespace stdvector {
+
+template <typename T>
+class TransientVector;
+
+template <typename T>
+class PersistentVector {
+  public:
+    static constexpr size_t bits = 5;
+    static constexpr size_t width = size_t(1) << bits;
+    static constexpr size_t mask = width - 1;
+
+    PersistentVector() : size_(0), shift_(bits),
+                         root_(smart_ptr::MakeShared<Branch>()), tail_(smart_ptr::MakeShared<Leaf>()) {}
+
+    const T& operator [](size_t idx) const {
+        return leafFor(idx)->values[idx & mask];
+    }
+
+    //returns a new version, this one is left untouched
+    PersistentVector set(size_t idx, const T& val) const {
+        PersistentVector result(*this);
+        if (idx >= tailOffset()) {
+            result.tail_ = smart_ptr::MakeShared<Leaf>(*tail_);
+            result.tail_->values[idx & mask] = val;
+        } else {
+            result.root_ = assoc(shift_, *root_, idx, val);
+        }
+        return result;
+    }
+
+    PersistentVector pushBack(const T& val) const {
+        PersistentVector result(*this);
+        if (size_ - tailOffset() < width) {
+            result.tail_ = smart_ptr::MakeShared<Leaf>(*tail_);
+        } else {
+            if ((size_ >> bits) > (size_t(1) << shift_)) {
+                result.root_ = smart_ptr::MakeShared<Branch>();
+                result.root_->children[0] = root_;
+                result.root_->children[1] = newPath(shift_, tail_);
+                result.shift_ += bits;
+            } else {
+                result.root_ = pushTail(shift_, *root_, tail_);
+            }
+            result.tail_ = smart_ptr::MakeShared<Leaf>();
+        }
+        result.tail_->values[size_ & mask] = val;
+        ++result.size_;
+        return result;
+    }
+
+    //mutable builder sharing this version's nodes
+    TransientVector<T> transient() const {
+        return TransientVector<T>(size_, shift_, root_, tail_);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+  private:
+    friend class TransientVector<T>;
+
+    //Branches keep one array of children: branches above the last level,
+    //leaves on it, so the level says which one a child is. Each node is
+    //created as its real type and its block destroys it as such.
+    struct Node {};
+    //T must be default constructible: leaves are always full arrays
+    struct Leaf : Node {
+        T values[width];
+    };
+    struct Branch : Node {
+        smart_ptr::SharedPtr<Node> children[width];
+    };
+
+    using NodePtr = smart_ptr::SharedPtr<Node>;
+    using BranchPtr = smart_ptr::SharedPtr<Branch>;
+    using LeafPtr = smart_ptr::SharedPtr<Leaf>;
+
+    static Branch* asBranch(const NodePtr& ptr) {
+        return static_cast<Branch*>(ptr.get());
+    }
+    static Leaf* asLeaf(const NodePtr& ptr) {
+        return static_cast<Leaf*>(ptr.get());
+    }
+
+    PersistentVector(size_t size, size_t shift, const BranchPtr& root, const LeafPtr& tail)
+        : size_(size), shift_(shift), root_(root), tail_(tail) {}
+
+    size_t tailOffset() const {
+        return size_ < width ? 0 : ((size_ - 1) >> bits) << bits;
+    }
+
+    Leaf* leafFor(size_t idx) const {
+        if (idx >= tailOffset()) {
+            return tail_.get();
+        }
+        Branch* node = root_.get();
+        for (size_t level = shift_; level > bits; level -= bits) {
+            node = asBranch(node->children[(idx >> level) & mask]);
+        }
+        return asLeaf(node->children[(idx >> bits) & mask]);
+    }
+
+    static BranchPtr assoc(size_t level, const Branch& node, size_t idx, const T& val) {
+        BranchPtr copy = smart_ptr::MakeShared<Branch>(node);
+        size_t sub = (idx >> level) & mask;
+        if (level == bits) {
+            LeafPtr leaf = smart_ptr::MakeShared<Leaf>(*asLeaf(node.children[sub]));
+            leaf->values[idx & mask] = val;
+            copy->children[sub] = std::move(leaf);
+        } else {
+            copy->children[sub] = assoc(level - bits, *asBranch(node.children[sub]), idx, val);
+        }
+        return copy;
+    }
+
+    //chain of single-child branches from level down to leaf
+    static BranchPtr newPath(size_t level, const LeafPtr& leaf) {
+        BranchPtr node = smart_ptr::MakeShared<Branch>();
+        if (level == bits) {
+            node->children[0] = leaf;
+        } else {
+            node->children[0] = newPath(level - bits, leaf);
+        }
+        return node;
+    }
+
+    BranchPtr pushTail(size_t level, const Branch& node, const LeafPtr& leaf) const {
+        BranchPtr copy = smart_ptr::MakeShared<Branch>(node);
+        size_t sub = ((size_ - 1) >> level) & mask;
+        if (level == bits) {
+            copy->children[sub] = leaf;
+        } else if (node.children[sub]) {
+            copy->children[sub] = pushTail(level - bits, *asBranch(node.children[sub]), leaf);
+        } else {
+            copy->children[sub] = newPath(level - bits, leaf);
+        }
+        return copy;
+    }
+
+    size_t size_;
+    size_t shift_;     //bit offset of the root level
+    BranchPtr root_;
+    LeafPtr tail_;
+};
+
+//Batch builder: nodes referenced only by this transient are edited in
+//place, shared ones are copied on first write. A node is exclusively ours
+//when its use count is one, as every version holds its own reference.
+template <typename T>
+class TransientVector {
+  public:
+    TransientVector() : TransientVector(PersistentVector<T>().transient()) {}
+
+    const T& operator [](size_t idx) const {
+        if (idx >= tailOffset()) {
+            return tail_->values[idx & Vec::mask];
+        }
+        Branch* node = root_.get();
+        for (size_t level = shift_; level > Vec::bits; level -= Vec::bits) {
+            node = Vec::asBranch(node->children[(idx >> level) & Vec::mask]);
+        }
+        return Vec::asLeaf(node->children[(idx >> Vec::bits) & Vec::mask])->values[idx & Vec::mask];
+    }
+
+    TransientVector& set(size_t idx, const T& val) {
+        if (idx >= tailOffset()) {
+            editable<Leaf>(tail_)->values[idx & Vec::mask] = val;
+            return *this;
+        }
+        Branch* node = editable<Branch>(root_);
+        for (size_t level = shift_; level > Vec::bits; level -= Vec::bits) {
+            node = editable<Branch>(node->children[(idx >> level) & Vec::mask]);
+        }
+        editable<Leaf>(node->children[(idx >> Vec::bits) & Vec::mask])->values[idx & Vec::mask] = val;
+        return *this;
+    }
+
+    TransientVector& pushBack(const T& val) {
+        if (size_ - tailOffset() == Vec::width) {
+            if ((size_ >> Vec::bits) > (size_t(1) << shift_)) {
+                BranchPtr root = smart_ptr::MakeShared<Branch>();
+                root->children[0] = root_;
+                root->children[1] = Vec::newPath(shift_, tail_);
+                root_ = root;
+                shift_ += Vec::bits;
+            } else {
+                pushTail();
+            }
+            tail_ = smart_ptr::MakeShared<Leaf>();
+        }
+        editable<Leaf>(tail_)->values[size_ & Vec::mask] = val;
+        ++size_;
+        return *this;
+    }
+
+    //freezes the current content; later edits here copy what they touch
+    PersistentVector<T> persistent() const {
+        return snapshot();
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    friend class PersistentVector<T>;
+
+    using Vec = PersistentVector<T>;
+    using Branch = typename Vec::Branch;
+    using Leaf = typename Vec::Leaf;
+    using NodePtr = typename Vec::NodePtr;
+    using BranchPtr = typename Vec::BranchPtr;
+    using LeafPtr = typename Vec::LeafPtr;
+
+    TransientVector(size_t size, size_t shift, const BranchPtr& root, const LeafPtr& tail)
+        : size_(size), shift_(shift), root_(root), tail_(tail) {}
+
+    PersistentVector<T> snapshot() const {
+        return PersistentVector<T>(size_, shift_, root_, tail_);
+    }
+
+    size_t tailOffset() const {
+        return size_ < Vec::width ? 0 : ((size_ - 1) >> Vec::bits) << Vec::bits;
+    }
+
+    //Kind is the real type of the node ptr points to
+    template <typename Kind, typename Ptr>
+    static Kind* editable(Ptr& ptr) {
+        if (ptr.count() != 1) {
+            ptr = smart_ptr::MakeShared<Kind>(*static_cast<Kind*>(ptr.get()));
+        }
+        return static_cast<Kind*>(ptr.get());
+    }
+
+    void pushTail() {
+        Branch* node = editable<Branch>(root_);
+        for (size_t level = shift_; level > Vec::bits; level -= Vec::bits) {
+            NodePtr& child = node->children[((size_ - 1) >> level) & Vec::mask];
+            if (!child) {
+                child = Vec::newPath(level - Vec::bits, tail_);
+                return;
+            }
+            node = editable<Branch>(child);
+        }
+        node->children[((size_ - 1) >> Vec::bits) & Vec::mask] = tail_;
+    }
+
+    size_t size_;
+    size_t shift_;
+    BranchPtr root_;
+    LeafPtr tail_;
+};
+
+} //namespace stdvector
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <utility>
+#include <functional>
+
+#include "vector2.hpp"
+
+//d-ary heap over Vector. With 4 children per node a sift down touches half
+//as many levels as a binary heap and the children share a cache line.
+//The comparator is a template parameter so calls to it are inlined.
+
+namespace stdvector {
+
+template <typename T, typename Compare = std::less<T>, size_t Arity = 4>
+class PriorityQueue {
+    static_assert(Arity >= 2, "heap arity must be at least 2");
+
+  public:
+    //identifies an element for update/erase; recycled once the element leaves
+    using Handle = size_t;
+
+    PriorityQueue() {}
+    explicit PriorityQueue(const Compare& comp) : comp_(comp) {}
+
+    //top is the greatest element with respect to Compare, as in std::priority_queue
+    const T& top() const {
+        return values_.data()[0];
+    }
+    Handle topHandle() const {
+        return handles_.data()[0];
+    }
+
+    Handle push(const T& val) {
+        Handle handle = newHandle();
+        values_.pushBack(val);
+        handles_.pushBack(handle);
+        siftUp(values_.size() - 1);
+        return handle;
+    }
+    Handle push(T&& val) {
+        Handle handle = newHandle();
+        values_.pushBack(std::move(val));
+        handles_.pushBack(handle);
+        siftUp(values_.size() - 1);
+        return handle;
+    }
+
+    void pop() {
+        removeAt(0);
+    }
+
+    //push followed by pop in a single sift; returns val itself without
+    //touching the heap if it would be the new top. Otherwise, as with
+    //replaceTop, the popped top's handle (topHandle() before the call)
+    //now refers to val.
+    T pushPop(T val) {
+        if (empty() || !comp_(val, top())) {
+            return val;
+        }
+        T result = std::move(values_.data()[0]);
+        values_.data()[0] = std::move(val);
+        siftDown(0);
+        return result;
+    }
+
+    //pop followed by push; the top's handle now refers to val
+    Handle replaceTop(T val) {
+        Handle handle = handles_.data()[0];
+        values_.data()[0] = std::move(val);
+        siftDown(0);
+        return handle;
+    }
+
+    //new value may move the element either way (decrease or increase key)
+    void update(Handle handle, T val) {
+        size_t pos = positions_.data()[handle];
+        bool up = comp_(values_.data()[pos], val);
+        values_.data()[pos] = std::move(val);
+        if (up) {
+            siftUp(pos);
+        } else {
+            siftDown(pos);
+        }
+    }
+
+    void erase(Handle handle) {
+        removeAt(positions_.data()[handle]);
+    }
+
+    bool contains(Handle handle) const {
+        return handle < positions_.size() && positions_.data()[handle] != npos;
+    }
+    const T& get(Handle handle) const {
+        return values_.data()[positions_.data()[handle]];
+    }
+
+    //takes over the buffer of values and builds the heap bottom-up in O(n);
+    //drops the current content and its handles
+    void heapify(Vector<T>&& values) {
+        clear();
+        values_.swap(values);
+        values.clear();
+        for (size_t i = 0; i < values_.size(); ++i) {
+            handles_.pushBack(i);
+            positions_.pushBack(i);
+        }
+        if (values_.size() < 2) {
+            return;
+        }
+        for (size_t i = parent(values_.size() - 1) + 1; i-- > 0;) {
+            siftDown(i);
+        }
+    }
+
+    void clear() {
+        values_.clear();
+        handles_.clear();
+        positions_.clear();
+        free_handles_.clear();
+    }
+
+    size_t size() const {
+        return values_.size();
+    }
+    bool empty() const {
+        return values_.size() == 0;
+    }
+
+  private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    static size_t parent(size_t pos) {
+        return (pos - 1) / Arity;
+    }
+
+    Handle newHandle() {
+        if (free_handles_.size() > 0) {
+            Handle handle = free_handles_.data()[free_handles_.size() - 1];
+            free_handles_.popBack();
+            return handle;
+        }
+        positions_.pushBack(npos);
+        return positions_.size() - 1;
+    }
+    void releaseHandle(Handle handle) {
+        positions_.data()[handle] = npos;
+        free_handles_.pushBack(handle);
+    }
+
+    void removeAt(size_t pos) {
+        releaseHandle(handles_.data()[pos]);
+        size_t last = values_.size() - 1;
+        if (pos != last) {
+            values_.data()[pos] = std::move(values_.data()[last]);
+            handles_.data()[pos] = handles_.data()[last];
+        }
+        values_.popBack();
+        handles_.popBack();
+        if (pos != last) {
+            if (pos > 0 && comp_(values_.data()[parent(pos)], values_.data()[pos])) {
+                siftUp(pos);
+            } else {
+                siftDown(pos);
+            }
+        }
+    }
+
+    //both sifts move a hole instead of swapping
+    void siftUp(size_t pos) {
+        T* values = values_.data();
+        Handle* handles = handles_.data();
+        T val = std::move(values[pos]);
+        Handle handle = handles[pos];
+        while (pos > 0) {
+            size_t up = parent(pos);
+            if (!comp_(values[up], val)) {
+                break;
+            }
+            values[pos] = std::move(values[up]);
+            handles[pos] = handles[up];
+            positions_.data()[handles[pos]] = pos;
+            pos = up;
+        }
+        values[pos] = std::move(val);
+        handles[pos] = handle;
+        positions_.data()[handle] = pos;
+    }
+
+    void siftDown(size_t pos) {
+        T* values = values_.data();
+        Handle* handles = handles_.data();
+        size_t count = values_.size();
+        T val = std::move(values[pos]);
+        Handle handle = handles[pos];
+        while (true) {
+            size_t first = pos * Arity + 1;
+            if (first >= count) {
+                break;
+            }
+            size_t last = first + Arity < count ? first + Arity : count;
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (comp_(values[best], values[child])) {
+                    best = child;
+                }
+            }
+            if (!comp_(val, values[best])) {
+                break;
+            }
+            values[pos] = std::move(values[best]);
+            handles[pos] = handles[best];
+            positions_.data()[handles[pos]] = pos;
+            pos = best;
+        }
+        values[pos] = std::move(val);
+        handles[pos] = handle;
+        positions_.data()[handle] = pos;
+    }
+
+    Vector<T> values_;
+    Vector<Handle> handles_;       //position -> handle
+    Vector<size_t> positions_;     //handle -> position, npos if free
+    Vector<Handle> free_handles_;
+    Compare comp_;
+};
+
+} //namespace stdvector
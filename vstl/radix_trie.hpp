@@ -0,0 +1,488 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "object_pool.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+
+//Adaptive radix trie (ART) over byte strings for prefix queries: exact
+//lookup, longest stored prefix of a key, and in-order walks of every key
+//starting with a prefix. Chains of single-child nodes are collapsed into a
+//prefix kept on the node below, and inner nodes come in four sizes (4, 16,
+//48 and 256 children) and are replaced by the next size when they fill up.
+//Nodes and entries are allocated from ObjectPools.
+
+namespace stdvector {
+
+template <typename Value>
+class RadixTrie {
+  public:
+    struct Entry {
+        String key;
+        Value value;
+    };
+
+    RadixTrie() : root_(nullptr), size_(0) {}
+    RadixTrie(const RadixTrie&) = delete;
+    RadixTrie(RadixTrie&& other) : RadixTrie() {
+        swap(other);
+    }
+    ~RadixTrie() {
+        clear();
+    }
+
+    RadixTrie& operator=(const RadixTrie&) = delete;
+    RadixTrie& operator=(RadixTrie&& other) {
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    void swap(RadixTrie& other) {
+        std::swap(root_, other.root_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    //false and no change if key is already there
+    bool insert(StringView key, const Value& value) {
+        return insertImpl(key, value, false);
+    }
+    void insertOrAssign(StringView key, const Value& value) {
+        insertImpl(key, value, true);
+    }
+
+    //nullptr if key is absent
+    Value* find(StringView key) {
+        return const_cast<Value*>(static_cast<const RadixTrie*>(this)->find(key));
+    }
+    const Value* find(StringView key) const {
+        const Node* node = root_;
+        size_t depth = 0;
+        while (node != nullptr) {
+            size_t prefix_len = node->prefix.size();
+            if (matchPrefix(node, key, depth) < prefix_len) {
+                return nullptr;
+            }
+            depth += prefix_len;
+            if (depth == key.size()) {
+                return node->entry != nullptr ? &node->entry->value : nullptr;
+            }
+            node = childOf(node, static_cast<uint8_t>(key[depth]));
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    //the entry with the longest key that is a prefix of key, nullptr if none
+    const Entry* longestPrefix(StringView key) const {
+        const Entry* best = nullptr;
+        const Node* node = root_;
+        size_t depth = 0;
+        while (node != nullptr) {
+            size_t prefix_len = node->prefix.size();
+            if (matchPrefix(node, key, depth) < prefix_len) {
+                break;
+            }
+            depth += prefix_len;
+            if (node->entry != nullptr) {
+                best = node->entry;
+            }
+            if (depth == key.size()) {
+                break;
+            }
+            node = childOf(node, static_cast<uint8_t>(key[depth]));
+            ++depth;
+        }
+        return best;
+    }
+
+    //calls func with every entry whose key starts with prefix, in key order
+    template <typename Func>
+    void forEachWithPrefix(StringView prefix, Func&& func) const {
+        const Node* node = root_;
+        size_t depth = 0;
+        while (node != nullptr) {
+            size_t matched = matchPrefix(node, prefix, depth);
+            if (depth + matched == prefix.size()) {
+                visit(node, func);
+                return;
+            }
+            if (matched < node->prefix.size()) {
+                return;
+            }
+            depth += matched;
+            node = childOf(node, static_cast<uint8_t>(prefix[depth]));
+            ++depth;
+        }
+    }
+
+    template <typename Func>
+    void forEach(Func&& func) const {
+        forEachWithPrefix(StringView(), func);
+    }
+
+    void clear() {
+        if (root_ != nullptr) {
+            destroyNode(root_);
+            root_ = nullptr;
+        }
+        size_ = 0;
+    }
+
+  private:
+    enum Kind : uint8_t {
+        kind4,
+        kind16,
+        kind48,
+        kind256,
+    };
+
+    //entry is set when a key ends exactly after prefix
+    struct Node {
+        explicit Node(Kind node_kind) : kind(node_kind), count(0), entry(nullptr) {}
+
+        Kind kind;
+        uint16_t count;
+        String prefix;
+        Entry* entry;
+    };
+
+    //keys sorted, children[i] belongs to keys[i]
+    struct Node4 : Node {
+        Node4() : Node(kind4) {}
+
+        uint8_t keys[4];
+        Node* children[4];
+    };
+    struct Node16 : Node {
+        Node16() : Node(kind16) {}
+
+        uint8_t keys[16];
+        Node* children[16];
+    };
+    //index[byte] is the child's slot plus one, 0 for none
+    struct Node48 : Node {
+        Node48() : Node(kind48) {
+            std::memset(index, 0, sizeof(index));
+        }
+
+        uint8_t index[256];
+        Node* children[48];
+    };
+    struct Node256 : Node {
+        Node256() : Node(kind256) {
+            std::memset(children, 0, sizeof(children));
+        }
+
+        Node* children[256];
+    };
+
+    //how many bytes of node's prefix match key from depth on
+    static size_t matchPrefix(const Node* node, StringView key, size_t depth) {
+        size_t limit = node->prefix.size();
+        if (limit > key.size() - depth) {
+            limit = key.size() - depth;
+        }
+        const char* prefix = node->prefix.data();
+        size_t i = 0;
+        while (i < limit && prefix[i] == key[depth + i]) {
+            ++i;
+        }
+        return i;
+    }
+
+    //slot holding the child for byte, nullptr if there is none
+    static Node** childSlot(Node* node, uint8_t byte) {
+        switch (node->kind) {
+        case kind4: {
+            Node4* small = static_cast<Node4*>(node);
+            for (size_t i = 0; i < small->count; ++i) {
+                if (small->keys[i] == byte) {
+                    return &small->children[i];
+                }
+            }
+            return nullptr;
+        }
+        case kind16: {
+            Node16* medium = static_cast<Node16*>(node);
+#ifdef __SSE2__
+            __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(medium->keys));
+            uint32_t mask = static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(byte)))));
+            mask &= (uint32_t(1) << medium->count) - 1;
+            return mask != 0 ? &medium->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (size_t i = 0; i < medium->count; ++i) {
+                if (medium->keys[i] == byte) {
+                    return &medium->children[i];
+                }
+            }
+            return nullptr;
+#endif
+        }
+        case kind48: {
+            Node48* large = static_cast<Node48*>(node);
+            return large->index[byte] != 0 ? &large->children[large->index[byte] - 1] : nullptr;
+        }
+        default: {
+            Node256* full = static_cast<Node256*>(node);
+            return full->children[byte] != nullptr ? &full->children[byte] : nullptr;
+        }
+        }
+    }
+
+    static const Node* childOf(const Node* node, uint8_t byte) {
+        Node** slot = childSlot(const_cast<Node*>(node), byte);
+        return slot != nullptr ? *slot : nullptr;
+    }
+
+    template <typename Small>
+    static void insertSorted(Small* node, uint8_t byte, Node* child) {
+        size_t pos = node->count;
+        while (pos > 0 && node->keys[pos - 1] > byte) {
+            node->keys[pos] = node->keys[pos - 1];
+            node->children[pos] = node->children[pos - 1];
+            --pos;
+        }
+        node->keys[pos] = byte;
+        node->children[pos] = child;
+        ++node->count;
+    }
+
+    //moves prefix and entry over to a new node of the next size
+    template <typename To, typename From>
+    static To* growInto(From* from) {
+        To* to = ObjectPool<To>::create();
+        to->prefix = std::move(from->prefix);
+        to->entry = from->entry;
+        return to;
+    }
+
+    //*ref may be replaced by a bigger node
+    static void addChild(Node** ref, uint8_t byte, Node* child) {
+        Node* node = *ref;
+        switch (node->kind) {
+        case kind4: {
+            Node4* small = static_cast<Node4*>(node);
+            if (small->count < 4) {
+                insertSorted(small, byte, child);
+                return;
+            }
+            Node16* grown = growInto<Node16>(small);
+            std::memcpy(grown->keys, small->keys, sizeof(small->keys));
+            std::memcpy(grown->children, small->children, sizeof(small->children));
+            grown->count = small->count;
+            ObjectPool<Node4>::destroy(small);
+            *ref = grown;
+            insertSorted(grown, byte, child);
+            return;
+        }
+        case kind16: {
+            Node16* medium = static_cast<Node16*>(node);
+            if (medium->count < 16) {
+                insertSorted(medium, byte, child);
+                return;
+            }
+            Node48* grown = growInto<Node48>(medium);
+            for (size_t i = 0; i < 16; ++i) {
+                grown->index[medium->keys[i]] = static_cast<uint8_t>(i + 1);
+                grown->children[i] = medium->children[i];
+            }
+            grown->count = 16;
+            ObjectPool<Node16>::destroy(medium);
+            *ref = grown;
+            addChild(ref, byte, child);
+            return;
+        }
+        case kind48: {
+            Node48* large = static_cast<Node48*>(node);
+            if (large->count < 48) {
+                large->children[large->count] = child;
+                large->index[byte] = static_cast<uint8_t>(++large->count);
+                return;
+            }
+            Node256* grown = growInto<Node256>(large);
+            for (size_t b = 0; b < 256; ++b) {
+                if (large->index[b] != 0) {
+                    grown->children[b] = large->children[large->index[b] - 1];
+                }
+            }
+            grown->count = 48;
+            ObjectPool<Node48>::destroy(large);
+            *ref = grown;
+            addChild(ref, byte, child);
+            return;
+        }
+        default: {
+            Node256* full = static_cast<Node256*>(node);
+            full->children[byte] = child;
+            ++full->count;
+            return;
+        }
+        }
+    }
+
+    static Node* makeLeaf(StringView prefix, Entry* entry) {
+        Node4* leaf = ObjectPool<Node4>::create();
+        leaf->prefix = String(prefix);
+        leaf->entry = entry;
+        return leaf;
+    }
+
+    static Entry* makeEntry(StringView key, const Value& value) {
+        return ObjectPool<Entry>::create(Entry{String(key), value});
+    }
+
+    bool insertImpl(StringView key, const Value& value, bool assign) {
+        if (root_ == nullptr) {
+            root_ = ObjectPool<Node4>::create();
+        }
+        Node** ref = &root_;
+        size_t depth = 0;
+        while (true) {
+            Node* node = *ref;
+            size_t matched = matchPrefix(node, key, depth);
+            if (matched < node->prefix.size()) {
+                //key leaves the compressed path: split it at the mismatch
+                Node4* parent = ObjectPool<Node4>::create();
+                StringView old_prefix(node->prefix);
+                parent->prefix = String(old_prefix.substr(0, matched));
+                uint8_t branch = static_cast<uint8_t>(old_prefix[matched]);
+                node->prefix = String(old_prefix.substr(matched + 1));
+                insertSorted(parent, branch, node);
+                *ref = parent;
+                depth += matched;
+                if (depth == key.size()) {
+                    parent->entry = makeEntry(key, value);
+                } else {
+                    addChild(ref, static_cast<uint8_t>(key[depth]), makeLeaf(key.substr(depth + 1), makeEntry(key, value)));
+                }
+                ++size_;
+                return true;
+            }
+            depth += matched;
+            if (depth == key.size()) {
+                if (node->entry != nullptr) {
+                    if (assign) {
+                        node->entry->value = value;
+                    }
+                    return false;
+                }
+                node->entry = makeEntry(key, value);
+                ++size_;
+                return true;
+            }
+            uint8_t byte = static_cast<uint8_t>(key[depth]);
+            Node** child = childSlot(node, byte);
+            if (child == nullptr) {
+                addChild(ref, byte, makeLeaf(key.substr(depth + 1), makeEntry(key, value)));
+                ++size_;
+                return true;
+            }
+            ref = child;
+            ++depth;
+        }
+    }
+
+    //entry first, it sorts before every longer key below the node
+    template <typename Func>
+    static void visit(const Node* node, Func& func) {
+        if (node->entry != nullptr) {
+            func(static_cast<const Entry&>(*node->entry));
+        }
+        switch (node->kind) {
+        case kind4: {
+            const Node4* small = static_cast<const Node4*>(node);
+            for (size_t i = 0; i < small->count; ++i) {
+                visit(small->children[i], func);
+            }
+            break;
+        }
+        case kind16: {
+            const Node16* medium = static_cast<const Node16*>(node);
+            for (size_t i = 0; i < medium->count; ++i) {
+                visit(medium->children[i], func);
+            }
+            break;
+        }
+        case kind48: {
+            const Node48* large = static_cast<const Node48*>(node);
+            for (size_t b = 0; b < 256; ++b) {
+                if (large->index[b] != 0) {
+                    visit(large->children[large->index[b] - 1], func);
+                }
+            }
+            break;
+        }
+        default: {
+            const Node256* full = static_cast<const Node256*>(node);
+            for (size_t b = 0; b < 256; ++b) {
+                if (full->children[b] != nullptr) {
+                    visit(full->children[b], func);
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    static void destroyNode(Node* node) {
+        if (node->entry != nullptr) {
+            ObjectPool<Entry>::destroy(node->entry);
+        }
+        switch (node->kind) {
+        case kind4: {
+            Node4* small = static_cast<Node4*>(node);
+            for (size_t i = 0; i < small->count; ++i) {
+                destroyNode(small->children[i]);
+            }
+            ObjectPool<Node4>::destroy(small);
+            break;
+        }
+        case kind16: {
+            Node16* medium = static_cast<Node16*>(node);
+            for (size_t i = 0; i < medium->count; ++i) {
+                destroyNode(medium->children[i]);
+            }
+            ObjectPool<Node16>::destroy(medium);
+            break;
+        }
+        case kind48: {
+            Node48* large = static_cast<Node48*>(node);
+            for (size_t i = 0; i < large->count; ++i) {
+                destroyNode(large->children[i]);
+            }
+            ObjectPool<Node48>::destroy(large);
+            break;
+        }
+        default: {
+            Node256* full = static_cast<Node256*>(node);
+            for (size_t b = 0; b < 256; ++b) {
+                if (full->children[b] != nullptr) {
+                    destroyNode(full->children[b]);
+                }
+            }
+            ObjectPool<Node256>::destroy(full);
+            break;
+        }
+        }
+    }
+
+    Node* root_;
+    size_t size_;
+};
+
+} //namespace stdvector
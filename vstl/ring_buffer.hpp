@@ -0,0 +1,237 @@
+#pragma once
+
+#include <utility>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <stdexcept>
+
+#include "vector2.hpp"
+
+//Circular deque over a power of two storage: O(1) push and pop at both
+//ends. Any run of elements occupies at most two contiguous spans.
+
+namespace stdvector {
+
+template <typename T, size_t N = 0, template <typename, size_t> class Storage = DynamicMemory>
+class RingBuffer : protected Storage<T, N> {
+    static_assert((N & (N - 1)) == 0, "ring buffer capacity must be a power of two");
+
+  public:
+    RingBuffer() : Storage<T, N>(), head_(0), size_(0), overwrite_(false) {}
+
+    //capacity is rounded up to a power of two; with overwrite_oldest the
+    //buffer never grows and pushes into a full buffer drop the oldest element
+    explicit RingBuffer(size_t capacity, bool overwrite_oldest = false) : RingBuffer() {
+        while (this->Storage<T, N>::capacity() < capacity) {
+            this->storageRealloc(0, 0);
+        }
+        overwrite_ = overwrite_oldest;
+    }
+    RingBuffer(const RingBuffer&) = delete;
+    ~RingBuffer() {
+        clear();
+    }
+
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    T& operator [](size_t idx) {
+        return this->data()[(head_ + idx) & mask()];
+    }
+    const T& operator [](size_t idx) const {
+        return this->data()[(head_ + idx) & mask()];
+    }
+
+    T& front() {
+        return this->data()[head_];
+    }
+    T& back() {
+        return this->data()[(head_ + size_ - 1) & mask()];
+    }
+
+    void pushBack(const T& val) {
+        if (size_ == capacity()) {
+            if (overwrite_) {
+                this->data()[head_] = val;
+                head_ = (head_ + 1) & mask();
+                return;
+            }
+            //val may be an element, copy it out before grow() frees them
+            pushBack(T(val));
+            return;
+        }
+        this->Storage<T, N>::insert((head_ + size_) & mask(), val);
+        ++size_;
+    }
+    void pushBack(T&& val) {
+        if (size_ == capacity()) {
+            if (overwrite_) {
+                this->data()[head_] = std::move(val);
+                head_ = (head_ + 1) & mask();
+                return;
+            }
+            //val may be an element, move it out before grow() frees them
+            T tmp(std::move(val));
+            grow();
+            this->Storage<T, N>::insert((head_ + size_) & mask(), std::move(tmp));
+            ++size_;
+            return;
+        }
+        this->Storage<T, N>::insert((head_ + size_) & mask(), std::move(val));
+        ++size_;
+    }
+
+    //in overwrite mode a full buffer drops its newest element instead
+    void pushFront(const T& val) {
+        if (size_ == capacity()) {
+            if (overwrite_) {
+                head_ = (head_ - 1) & mask();
+                this->data()[head_] = val;
+                return;
+            }
+            pushFront(T(val));
+            return;
+        }
+        head_ = (head_ - 1) & mask();
+        this->Storage<T, N>::insert(head_, val);
+        ++size_;
+    }
+    void pushFront(T&& val) {
+        if (size_ == capacity()) {
+            if (overwrite_) {
+                head_ = (head_ - 1) & mask();
+                this->data()[head_] = std::move(val);
+                return;
+            }
+            T tmp(std::move(val));
+            grow();
+            head_ = (head_ - 1) & mask();
+            this->Storage<T, N>::insert(head_, std::move(tmp));
+            ++size_;
+            return;
+        }
+        head_ = (head_ - 1) & mask();
+        this->Storage<T, N>::insert(head_, std::move(val));
+        ++size_;
+    }
+
+    void popFront() {
+        this->data()[head_].~T();
+        head_ = (head_ + 1) & mask();
+        --size_;
+    }
+    void popBack() {
+        --size_;
+        this->data()[(head_ + size_) & mask()].~T();
+    }
+
+    //copies count elements behind the back in at most two spans; src may
+    //point into this buffer
+    void pushN(const T* src, size_t count) {
+        std::less<const T*> less;
+        if (count > 0 && !less(src, this->data()) && less(src, this->data() + capacity())) {
+            //growing or dropping the oldest would free src, copy it out first
+            Vector<T> copy;
+            copy.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                copy.pushBack(src[i]);
+            }
+            pushN(copy.data(), count);
+            return;
+        }
+        if (overwrite_) {
+            if (count >= capacity()) {
+                clear();
+                src += count - capacity();
+                count = capacity();
+            }
+            while (size_ + count > capacity()) {
+                popFront();
+            }
+        } else {
+            while (size_ + count > capacity()) {
+                grow();
+            }
+        }
+
+        size_t tail = (head_ + size_) & mask();
+        size_t first_span = capacity() - tail < count ? capacity() - tail : count;
+        copyIn(this->data() + tail, src, first_span);
+        copyIn(this->data(), src + first_span, count - first_span);
+        size_ += count;
+    }
+
+    //moves up to count elements from the front into dst, returns how many
+    size_t popN(T* dst, size_t count) {
+        if (count > size_) {
+            count = size_;
+        }
+        size_t first_span = capacity() - head_ < count ? capacity() - head_ : count;
+        moveOut(dst, this->data() + head_, first_span);
+        moveOut(dst + first_span, this->data(), count - first_span);
+        head_ = (head_ + count) & mask();
+        size_ -= count;
+        return count;
+    }
+
+    void clear() {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            while (size_ > 0) {
+                popBack();
+            }
+        }
+        head_ = 0;
+        size_ = 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+    size_t capacity() const {
+        return this->Storage<T, N>::capacity();
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    bool full() const {
+        return size_ == capacity();
+    }
+
+  private:
+    size_t mask() const {
+        return capacity() - 1;
+    }
+
+    //storage unwraps the buffer while growing, so the front lands at 0
+    void grow() {
+        this->storageRealloc(head_, size_);
+        head_ = 0;
+    }
+
+    static void copyIn(T* dst, const T* src, size_t count) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            std::memcpy(dst, src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                new(dst + i) T(src[i]);
+            }
+        }
+    }
+
+    static void moveOut(T* dst, T* src, size_t count) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            std::memcpy(dst, src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = std::move(src[i]);
+                src[i].~T();
+            }
+        }
+    }
+
+    size_t head_;     //index of the front element
+    size_t size_;
+    bool overwrite_;
+};
+
+} //namespace stdvector
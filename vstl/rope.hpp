@@ -0,0 +1,271 @@
+#pragma once
+
+#include <utility>
+#include <stdexcept>
+
+#include "smart_ptr.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+#include "vector2.hpp"
+
+//Rope for large documents built piece by piece. Text lives in leaves that
+//are slices of shared String buffers; inner nodes concatenate two subtrees
+//and are kept height balanced (AVL style joins), so appending, prepending,
+//indexing and taking substrings touch O(log n) nodes and never copy big
+//leaves. Small pieces are merged into the first or last leaf while it stays
+//under merge_limit, so a run of short appends does not grow the tree.
+//Nodes are immutable and shared, copies of a Rope are cheap.
+
+namespace stdvector {
+
+class Rope {
+  public:
+    //neighbouring leaves up to this size together are merged into one buffer
+    static constexpr size_t merge_limit = 256;
+
+    Rope() {}
+    Rope(StringView str) {
+        if (str.size() > 0) {
+            root_ = makeLeaf(smart_ptr::MakeShared<String>(str), 0, str.size());
+        }
+    }
+    //takes the buffer over without copying it
+    Rope(String&& str) {
+        size_t len = str.size();
+        if (len > 0) {
+            root_ = makeLeaf(smart_ptr::MakeShared<String>(std::move(str)), 0, len);
+        }
+    }
+
+    size_t size() const {
+        return root_ ? root_->length : 0;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+
+    //throws std::out_of_range past the end, an empty rope has no root
+    char operator [](size_t idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range("Rope::operator[]");
+        }
+        Node* node = root_.get();
+        while (node->depth > 0) {
+            size_t left_len = node->left->length;
+            if (idx < left_len) {
+                node = node->left.get();
+            } else {
+                idx -= left_len;
+                node = node->right.get();
+            }
+        }
+        return node->buffer->data()[node->offset + idx];
+    }
+
+    Rope& append(const Rope& other) {
+        root_ = join(root_, other.root_);
+        return *this;
+    }
+    Rope& append(String&& str) {
+        return append(Rope(std::move(str)));
+    }
+    Rope& append(StringView str) {
+        return append(Rope(str));
+    }
+    Rope& prepend(const Rope& other) {
+        root_ = join(other.root_, root_);
+        return *this;
+    }
+    Rope& prepend(String&& str) {
+        return prepend(Rope(std::move(str)));
+    }
+    Rope& prepend(StringView str) {
+        return prepend(Rope(str));
+    }
+
+    Rope& operator+=(const Rope& other) {
+        return append(other);
+    }
+    Rope& operator+=(StringView str) {
+        return append(str);
+    }
+
+    //shares the leaves' buffers; count is clamped to the end
+    Rope substr(size_t pos, size_t count = StringView::npos) const {
+        if (pos > size()) {
+            throw std::out_of_range("Rope::substr");
+        }
+        if (count > size() - pos) {
+            count = size() - pos;
+        }
+        Rope result;
+        result.root_ = slice(root_, pos, count);
+        return result;
+    }
+
+    //contiguous copy of the whole text
+    String flatten() const {
+        String result(size(), '\0');
+        char* dst = result.data();
+        forEachSpan([&dst](StringView span) {
+            std::memcpy(dst, span.data(), span.size());
+            dst += span.size();
+        });
+        return result;
+    }
+
+    //calls func with every leaf in order, e.g. to fill an iovec for writev
+    template <typename Func>
+    void forEachSpan(Func&& func) const {
+        if (root_) {
+            visit(root_.get(), func);
+        }
+    }
+
+    Vector<StringView> spans() const {
+        Vector<StringView> result;
+        forEachSpan([&result](StringView span) {
+            result.pushBack(span);
+        });
+        return result;
+    }
+
+    //height of the tree, leaves are 0
+    int depth() const {
+        return root_ ? root_->depth : 0;
+    }
+
+  private:
+    struct Node;
+    using NodePtr = smart_ptr::SharedPtr<Node>;
+    using BufferPtr = smart_ptr::SharedPtr<String>;
+
+    //leaf when depth is 0: length chars of buffer starting at offset
+    struct Node {
+        size_t length;
+        int depth;
+        NodePtr left;
+        NodePtr right;
+        BufferPtr buffer;
+        size_t offset;
+    };
+
+    static NodePtr makeLeaf(const BufferPtr& buffer, size_t offset, size_t length) {
+        if (length == 0) {
+            return NodePtr();
+        }
+        return smart_ptr::MakeShared<Node>(Node{length, 0, NodePtr(), NodePtr(), buffer, offset});
+    }
+
+    static NodePtr makeNode(const NodePtr& left, const NodePtr& right) {
+        int depth = (left->depth > right->depth ? left->depth : right->depth) + 1;
+        return smart_ptr::MakeShared<Node>(Node{left->length + right->length, depth, left, right, BufferPtr(), 0});
+    }
+
+    static StringView leafView(const Node* leaf) {
+        return StringView(leaf->buffer->data() + leaf->offset, leaf->length);
+    }
+
+    static NodePtr mergeLeaves(const Node* lhs, const Node* rhs) {
+        size_t length = lhs->length + rhs->length;
+        String merged;
+        char* dst = detail::StringTail::grow(merged, length);
+        std::memcpy(dst, leafView(lhs).data(), lhs->length);
+        std::memcpy(dst + lhs->length, leafView(rhs).data(), rhs->length);
+        detail::StringTail::commit(merged, length);
+        return makeLeaf(smart_ptr::MakeShared<String>(std::move(merged)), 0, length);
+    }
+
+    //node with leaf merged into its last leaf, the right spine copied and
+    //every depth unchanged; empty if the two leaves would pass merge_limit
+    static NodePtr mergeIntoLast(const NodePtr& node, const Node* leaf) {
+        if (node->depth == 0) {
+            return node->length + leaf->length <= merge_limit ? mergeLeaves(node.get(), leaf) : NodePtr();
+        }
+        NodePtr right = mergeIntoLast(node->right, leaf);
+        return right ? makeNode(node->left, right) : NodePtr();
+    }
+    static NodePtr mergeIntoFirst(const Node* leaf, const NodePtr& node) {
+        if (node->depth == 0) {
+            return leaf->length + node->length <= merge_limit ? mergeLeaves(leaf, node.get()) : NodePtr();
+        }
+        NodePtr left = mergeIntoFirst(leaf, node->left);
+        return left ? makeNode(left, node->right) : NodePtr();
+    }
+
+    //concatenation that keeps sibling heights within one of each other
+    static NodePtr join(const NodePtr& lhs, const NodePtr& rhs) {
+        if (!lhs) {
+            return rhs;
+        }
+        if (!rhs) {
+            return lhs;
+        }
+        if (rhs->depth == 0 && rhs->length < merge_limit) {
+            NodePtr merged = mergeIntoLast(lhs, rhs.get());
+            if (merged) {
+                return merged;
+            }
+        }
+        if (lhs->depth == 0 && lhs->length < merge_limit) {
+            NodePtr merged = mergeIntoFirst(lhs.get(), rhs);
+            if (merged) {
+                return merged;
+            }
+        }
+        if (lhs->depth > rhs->depth + 1) {
+            NodePtr right = join(lhs->right, rhs);
+            if (right->depth <= lhs->left->depth + 1) {
+                return makeNode(lhs->left, right);
+            }
+            if (right->left->depth <= right->right->depth) {
+                return makeNode(makeNode(lhs->left, right->left), right->right);
+            }
+            return makeNode(makeNode(lhs->left, right->left->left), makeNode(right->left->right, right->right));
+        }
+        if (rhs->depth > lhs->depth + 1) {
+            NodePtr left = join(lhs, rhs->left);
+            if (left->depth <= rhs->right->depth + 1) {
+                return makeNode(left, rhs->right);
+            }
+            if (left->right->depth <= left->left->depth) {
+                return makeNode(left->left, makeNode(left->right, rhs->right));
+            }
+            return makeNode(makeNode(left->left, left->right->left), makeNode(left->right->right, rhs->right));
+        }
+        return makeNode(lhs, rhs);
+    }
+
+    static NodePtr slice(const NodePtr& node, size_t pos, size_t count) {
+        if (count == 0) {
+            return NodePtr();
+        }
+        if (pos == 0 && count == node->length) {
+            return node;
+        }
+        if (node->depth == 0) {
+            return makeLeaf(node->buffer, node->offset + pos, count);
+        }
+        size_t left_len = node->left->length;
+        if (pos + count <= left_len) {
+            return slice(node->left, pos, count);
+        }
+        if (pos >= left_len) {
+            return slice(node->right, pos - left_len, count);
+        }
+        return join(slice(node->left, pos, left_len - pos), slice(node->right, 0, pos + count - left_len));
+    }
+
+    template <typename Func>
+    static void visit(const Node* node, Func& func) {
+        while (node->depth > 0) {
+            visit(node->left.get(), func);
+            node = node->right.get();
+        }
+        func(leafView(node));
+    }
+
+    NodePtr root_;
+};
+
+} //namespace stdvector
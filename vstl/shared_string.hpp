@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <functional>
+#include <new>
+
+#include "allocator.hpp"
+#include "hash.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+
+//String for values that are copied far more often than changed: copies
+//share one refcounted buffer (header and chars in a single allocation) and
+//cost an atomic increment. Mutating a shared buffer first detaches into a
+//private copy; a sole owner changes its buffer in place.
+
+namespace stdvector {
+
+class SharedString {
+  public:
+    SharedString() : rep_(nullptr) {}
+    SharedString(const char* str) : SharedString(StringView(str)) {}
+    SharedString(StringView str) : rep_(nullptr) {
+        if (str.size() > 0) {
+            rep_ = makeRep(str.size());
+            std::memcpy(rep_->chars(), str.data(), str.size());
+            rep_->setSize(str.size());
+        }
+    }
+    explicit SharedString(const String& str) : SharedString(StringView(str)) {}
+    SharedString(const SharedString& other) : rep_(other.rep_) {
+        if (rep_ != nullptr) {
+            rep_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    SharedString(SharedString&& other) : rep_(other.rep_) {
+        other.rep_ = nullptr;
+    }
+    ~SharedString() {
+        release(rep_);
+    }
+
+    SharedString& operator=(SharedString other) {
+        swap(other);
+        return *this;
+    }
+
+    void swap(SharedString& other) {
+        std::swap(rep_, other.rep_);
+    }
+
+    size_t size() const {
+        return rep_ != nullptr ? rep_->size : 0;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    size_t capacity() const {
+        return rep_ != nullptr ? rep_->capacity : 0;
+    }
+    //owners of the buffer, 0 for the empty string
+    size_t useCount() const {
+        return rep_ != nullptr ? rep_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    const char* data() const {
+        return rep_ != nullptr ? rep_->chars() : "";
+    }
+    const char* c_str() const {
+        return data();
+    }
+    char operator [](size_t idx) const {
+        return data()[idx];
+    }
+
+    operator StringView() const {
+        return StringView(data(), size());
+    }
+    String str() const {
+        return String(StringView(*this));
+    }
+
+    //detaches, the pointer stays valid until the next change or copy
+    char* mutableData() {
+        if (rep_ == nullptr) {
+            return nullptr;
+        }
+        makeUnique(size());
+        return rep_->chars();
+    }
+
+    SharedString& operator+=(StringView rhs) {
+        append(rhs.data(), rhs.size());
+        return *this;
+    }
+    SharedString& operator+=(const char* rhs) {
+        append(rhs, std::strlen(rhs));
+        return *this;
+    }
+    SharedString& operator+=(char rhs) {
+        append(&rhs, 1);
+        return *this;
+    }
+    void push_back(char ch) {
+        append(&ch, 1);
+    }
+    void clear() {
+        release(rep_);
+        rep_ = nullptr;
+    }
+
+  private:
+    struct Rep {
+        std::atomic<size_t> refs;
+        size_t size;
+        size_t capacity;
+
+        char* chars() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+        void setSize(size_t len) {
+            size = len;
+            chars()[len] = '\0';
+        }
+    };
+
+    static size_t repBytes(size_t capacity) {
+        return sizeof(Rep) + capacity + 1;
+    }
+
+    static Rep* makeRep(size_t capacity) {
+        Rep* rep = static_cast<Rep*>(allocateBytes(repBytes(capacity)));
+        new (&rep->refs) std::atomic<size_t>(1);
+        rep->size = 0;
+        rep->capacity = capacity;
+        return rep;
+    }
+
+    static void release(Rep* rep) {
+        if (rep != nullptr && rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            size_t bytes = repBytes(rep->capacity);
+            rep->refs.~atomic();
+            deallocateBytes(rep, bytes);
+        }
+    }
+
+    //sole owner of a buffer with room for min_capacity chars afterwards
+    void makeUnique(size_t min_capacity) {
+        if (rep_ != nullptr && rep_->capacity >= min_capacity &&
+            rep_->refs.load(std::memory_order_acquire) == 1) {
+            return;
+        }
+        size_t new_capacity = capacity();
+        if (new_capacity < min_capacity) {
+            new_capacity = new_capacity * 2 > min_capacity ? new_capacity * 2 : min_capacity;
+        }
+        Rep* rep = makeRep(new_capacity);
+        std::memcpy(rep->chars(), data(), size());
+        rep->setSize(size());
+        release(rep_);
+        rep_ = rep;
+    }
+
+    //src may point into the current buffer, which is then kept alive
+    //(and so copied from rather than changed) until the append is done
+    void append(const char* src, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        size_t len = size();
+        Rep* keep = nullptr;
+        std::less_equal<const char*> less_equal;
+        if (rep_ != nullptr && less_equal(rep_->chars(), src) && less_equal(src, rep_->chars() + len)) {
+            keep = rep_;
+            keep->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        makeUnique(len + count);
+        std::memcpy(rep_->chars() + len, src, count);
+        rep_->setSize(len + count);
+        release(keep);
+    }
+
+    Rep* rep_;
+};
+
+template <>
+struct Hash<SharedString> : Hash<String> {
+    using Hash<String>::operator();
+
+    uint64_t operator()(const SharedString& str) const {
+        return hashBytes(str.data(), str.size());
+    }
+};
+
+} //namespace stdvector
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "vector2.hpp"
+
+//Dense array of values addressed through stable handles. Values stay packed
+//for iteration (erase moves the last one into the hole); handles go through
+//a slot table whose generation counter changes on every insert and erase, so
+//a handle to an erased value is detected instead of reaching its successor.
+//Used slots have odd generations, free ones even.
+
+namespace stdvector {
+
+template <typename T>
+class SlotMap {
+  public:
+    struct Handle {
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator==(const Handle& other) const {
+            return index == other.index && generation == other.generation;
+        }
+        bool operator!=(const Handle& other) const {
+            return !(*this == other);
+        }
+    };
+
+    SlotMap() : free_head_(npos) {}
+
+    Handle insert(const T& val) {
+        Handle handle = takeSlot();
+        values_.pushBack(val);
+        return handle;
+    }
+    Handle insert(T&& val) {
+        Handle handle = takeSlot();
+        values_.pushBack(std::move(val));
+        return handle;
+    }
+
+    bool erase(Handle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots_.data()[handle.index];
+        size_t dense = slot.target;
+        size_t last = values_.size() - 1;
+        if (dense != last) {
+            values_.data()[dense] = std::move(values_.data()[last]);
+            owners_.data()[dense] = owners_.data()[last];
+            slots_.data()[owners_.data()[dense]].target = static_cast<uint32_t>(dense);
+        }
+        values_.popBack();
+        owners_.popBack();
+
+        ++slot.generation;
+        slot.target = free_head_;
+        free_head_ = handle.index;
+        return true;
+    }
+
+    bool contains(Handle handle) const {
+        //an even generation marks a free slot whose target is a free list link
+        return (handle.generation & 1) != 0 && handle.index < slots_.size() &&
+               slots_.data()[handle.index].generation == handle.generation;
+    }
+
+    //nullptr if the handle is stale
+    T* get(Handle handle) {
+        if (!contains(handle)) {
+            return nullptr;
+        }
+        return values_.data() + slots_.data()[handle.index].target;
+    }
+    const T* get(Handle handle) const {
+        if (!contains(handle)) {
+            return nullptr;
+        }
+        return values_.data() + slots_.data()[handle.index].target;
+    }
+
+    //handle of the value at a dense position, e.g. while iterating
+    Handle handleAt(size_t idx) const {
+        uint32_t index = owners_.data()[idx];
+        return Handle{index, slots_.data()[index].generation};
+    }
+
+    //dense iteration, order changes on erase
+    T* begin() {
+        return values_.data();
+    }
+    T* end() {
+        return values_.data() + values_.size();
+    }
+    const T* begin() const {
+        return values_.data();
+    }
+    const T* end() const {
+        return values_.data() + values_.size();
+    }
+
+    //invalidates every handle
+    void clear() {
+        for (size_t i = 0; i < owners_.size(); ++i) {
+            uint32_t index = owners_.data()[i];
+            Slot& slot = slots_.data()[index];
+            ++slot.generation;
+            slot.target = free_head_;
+            free_head_ = index;
+        }
+        values_.clear();
+        owners_.clear();
+    }
+
+    size_t size() const {
+        return values_.size();
+    }
+    bool empty() const {
+        return values_.size() == 0;
+    }
+
+  private:
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    struct Slot {
+        uint32_t target;       //dense index while used, next free slot otherwise
+        uint32_t generation;
+    };
+
+    Handle takeSlot() {
+        uint32_t index;
+        if (free_head_ != npos) {
+            index = free_head_;
+            free_head_ = slots_.data()[index].target;
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.pushBack(Slot{0, 0});
+        }
+        Slot& slot = slots_.data()[index];
+        ++slot.generation;
+        slot.target = static_cast<uint32_t>(values_.size());
+        owners_.pushBack(index);
+        return Handle{index, slot.generation};
+    }
+
+    Vector<T> values_;
+    Vector<uint32_t> owners_;    //dense index -> slot index
+    Vector<Slot> slots_;
+    uint32_t free_head_;
+};
+
+} //namespace stdvector
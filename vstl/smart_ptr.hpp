@@ -1,6 +1,13 @@
+#pragma once
+
 #include <stdio.h>
 #include <utility>
 #include <memory>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#include "object_pool.hpp"
 
 //Weak and Shared Ptr implementation
 
@@ -13,64 +20,81 @@ class SharedPtr;
 template <typename T>
 class WeakPtr;
 
+//Counters are atomic so copies of one pointer can live in different threads.
+//All shared owners together hold one weak reference, the block is freed when
+//the weak count drops to zero.
 class ControlBlockBase {
   public:
-    ControlBlockBase() : shared_count_(1), weak_count_(0) {}
-    ControlBlockBase(size_t shared_count, size_t weak_count) : shared_count_(shared_count), weak_count_(weak_count) {}
+    ControlBlockBase() : shared_count_(1), weak_count_(1), is_deleted_(false) {}
+    ControlBlockBase(size_t shared_count, size_t weak_count) : shared_count_(shared_count), weak_count_(weak_count + 1), is_deleted_(false) {}
     virtual ~ControlBlockBase() {};
 
     void incShared() {
-        ++shared_count_;
+        shared_count_.fetch_add(1, std::memory_order_relaxed);
     }
     size_t decShared() {
-        return --shared_count_;
+        return shared_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
     }
     void incWeak() { 
-        ++weak_count_;
+        weak_count_.fetch_add(1, std::memory_order_relaxed);
     }
     size_t decWeak() { 
-        return --weak_count_;
+        return weak_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
     }
 
     size_t sharedCount() const {
-        return shared_count_;
+        return shared_count_.load(std::memory_order_acquire);
     }
     size_t weakCount() const {
-        return weak_count_;
+        return weak_count_.load(std::memory_order_acquire);
     }
 
     virtual void deleteObject() = 0;
+    //frees the block itself through whatever allocated it
+    virtual void destroy() = 0;
 
     bool is_deleted() {
         return is_deleted_;
     }
 
   private:
-    size_t shared_count_;
-    size_t weak_count_;
+    std::atomic<size_t> shared_count_;
+    std::atomic<size_t> weak_count_;
   
   protected:
-    bool is_deleted_;
+    std::atomic<bool> is_deleted_;
 };
 
-template <typename T>
+//object and counters in one allocation made by Alloc
+template <typename T, typename Alloc>
 class ControlBlockOwner : public ControlBlockBase {
   public:
+    using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlockOwner>;
+
     template <typename... Args>
-    ControlBlockOwner(Args&&... args) : object_(std::forward<Args>(args)...) {}
+    ControlBlockOwner(const Alloc& alloc, Args&&... args) : alloc_(alloc) {
+        new(object_) T(std::forward<Args>(args)...);
+    }
     virtual ~ControlBlockOwner() override {};
 
     virtual void deleteObject() override {
-        object_.~T();
+        get()->~T();
         is_deleted_ = true;
     }
+    virtual void destroy() override {
+        BlockAlloc alloc(alloc_);
+        this->~ControlBlockOwner();
+        std::allocator_traits<BlockAlloc>::deallocate(alloc, this, 1);
+    }
 
     T* get() {
-        return &object_;
+        return reinterpret_cast<T*>(object_);
     }
 
   private:
-    T object_;
+    //raw storage, the object dies in deleteObject and not with the block
+    alignas(T) unsigned char object_[sizeof(T)];
+    Alloc alloc_;
 };
 
 template <typename T>
@@ -84,6 +108,9 @@ class ControlBlockUser : public ControlBlockBase {
         delete object_;
         is_deleted_ = true;
     }
+    virtual void destroy() override {
+        stdvector::ObjectPool<ControlBlockUser>::destroy(this);
+    }
 
   private:
     T* object_;
@@ -95,19 +122,35 @@ class SharedPtr {
     //constructing
     SharedPtr() : ptr_(nullptr), block_(nullptr) {};
     SharedPtr(T* ptr) : ptr_(ptr) {
-        block_ = new ControlBlockUser<T>(ptr);
+        block_ = stdvector::ObjectPool<ControlBlockUser<T>>::create(ptr);
     }
     SharedPtr(const SharedPtr<T>& shared_ptr) : ptr_(shared_ptr.ptr_), block_(shared_ptr.block_) {
-        block_->incShared();
+        if (block_ != nullptr) {
+            block_->incShared();
+        }
+    }
+    SharedPtr(SharedPtr<T>&& shared_ptr) : ptr_(shared_ptr.ptr_), block_(shared_ptr.block_) {
+        shared_ptr.ptr_ = nullptr;
+        shared_ptr.block_ = nullptr;
     }
-    SharedPtr(SharedPtr<T>&& shared_ptr) : ptr_(std::move(shared_ptr.ptr_)), block_(std::move(shared_ptr.block_)){    
+    //derived to base, shares the block of the derived pointer
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    SharedPtr(const SharedPtr<U>& shared_ptr) : ptr_(shared_ptr.ptr_), block_(shared_ptr.block_) {
+        if (block_ != nullptr) {
+            block_->incShared();
+        }
+    }
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    SharedPtr(SharedPtr<U>&& shared_ptr) : ptr_(shared_ptr.ptr_), block_(shared_ptr.block_) {
+        shared_ptr.ptr_ = nullptr;
+        shared_ptr.block_ = nullptr;
     }
     ~SharedPtr() {
         if (block_ != nullptr) {
             if (block_->decShared() == 0) {
                 block_->deleteObject();
-                if (block_->weakCount() == 0) {
-                    delete block_;
+                if (block_->decWeak() == 0) {
+                    block_->destroy();
                 }
             }
         }
@@ -126,38 +169,42 @@ class SharedPtr {
 
     SharedPtr& operator=(const SharedPtr<T>& ptr) {
         SharedPtr<T>(ptr).swap(*this);
+        return *this;
     }
     SharedPtr& operator=(SharedPtr<T>&& ptr) {
         SharedPtr<T>(std::move(ptr)).swap(*this);
+        return *this;
     }
 
     size_t count() const {
         return block_->sharedCount();
     }
     
-    operator bool() {
+    operator bool() const {
         return ptr_ != nullptr;
     }
 
-    T* get() {
+    T* get() const {
         return ptr_;
     }
-    T& operator*() {
+    T& operator*() const {
         return *ptr_;
     }
-    T* operator->() {
+    T* operator->() const {
         return ptr_;
     }
 
     friend class WeakPtr<T>;
+    template <typename U>
+    friend class SharedPtr;
     
-    template <typename Type, typename... Args>
-    friend SharedPtr<Type> MakeShared(Args&&... args );
+    template <typename Type, typename Alloc, typename... Args>
+    friend SharedPtr<Type> AllocateShared(const Alloc& alloc, Args&&... args);
   private:
     T* ptr_;
     ControlBlockBase* block_;
 
-    SharedPtr(ControlBlockOwner<T>* owner) : block_(owner), ptr_(owner->get()) {}
+    SharedPtr(ControlBlockBase* block, T* ptr) : ptr_(ptr), block_(block) {}
 };
 
 template <typename T>
@@ -170,21 +217,25 @@ class WeakPtr {
     WeakPtr(const SharedPtr<T>& shared) : ptr_(shared.ptr_), block_(shared.block_) {
         block_->incWeak();
     }
-    WeakPtr(WeakPtr<T>&& weak) : ptr_(std::move(weak.ptr_)), block_(std::move(weak.block_)) {
+    WeakPtr(WeakPtr<T>&& weak) : ptr_(weak.ptr_), block_(weak.block_) {
+        weak.ptr_ = nullptr;
+        weak.block_ = nullptr;
     }
     ~WeakPtr() {
         if (block_ != nullptr) {
-            if (block_->decWeak() == 0 && block_->sharedCount() == 0) {
-                delete block_;
+            if (block_->decWeak() == 0) {
+                block_->destroy();
             }
         }
     }
 
     WeakPtr& operator=(const WeakPtr<T>& ptr) {
         WeakPtr<T>(ptr).swap(*this);
+        return *this;
     }
     WeakPtr& operator=(WeakPtr<T>&& ptr) {
         WeakPtr<T>(std::move(ptr)).swap(*this);
+        return *this;
     }
 
     size_t count() {
@@ -215,9 +266,25 @@ class WeakPtr {
     ControlBlockBase* block_;
 };
 
+//single allocation for object and counters, taken from alloc
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateShared(const Alloc& alloc, Args&&... args) {
+    using Block = ControlBlockOwner<T, Alloc>;
+    typename Block::BlockAlloc block_alloc(alloc);
+    Block* block = std::allocator_traits<typename Block::BlockAlloc>::allocate(block_alloc, 1);
+    try {
+        new(block) Block(alloc, std::forward<Args>(args)...);
+    } catch (...) {
+        std::allocator_traits<typename Block::BlockAlloc>::deallocate(block_alloc, block, 1);
+        throw;
+    }
+    return SharedPtr<T>(block, block->get());
+}
+
+//blocks come from the shared object pool
 template <typename T, typename... Args>
 SharedPtr<T> MakeShared(Args&&... args) {
-    return SharedPtr<T>(new ControlBlockOwner<T>(std::forward<Args>(args)...));
+    return AllocateShared<T>(stdvector::PoolAllocator<T>(), std::forward<Args>(args)...);
 };
 
 } //namespace smart_ptr
\ No newline at end of file
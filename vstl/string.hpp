@@ -1,84 +1,110 @@
+#pragma once
+
 #include <exception>
 #include <iostream>
 #include <utility>
 #include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "allocator.hpp"
+#include "string_view.hpp"
+#include "number_format.hpp"
 
 namespace stdvector {
 
+template <typename Lhs, typename Rhs>
+class StringConcat;
+
+namespace detail {
+struct StringTail;
+} //namespace detail
+
+//24 bytes, libc++ style: strings of up to 22 chars live inline and their
+//length sits in the last byte; longer ones keep pointer, size and capacity
+//there instead, with the top bit of the capacity word (the same last byte
+//on little endian targets) marking the heap form. There is no pointer into
+//the object itself, so a String can be moved around with memcpy.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "String layout assumes a little endian target"
+#endif
+
 class String {
   public:
+    //the small form zeroes all three words, so no byte of large_ is ever
+    //read uninitialized (size() may load both forms before picking one)
+    String() {
+        std::memset(&large_, 0, sizeof(Large));
+    }
+
     String(const char* str) {
-        size_t len = std::strlen(str);
-        if (len > max_len - 1) {
-            is_small_ = false;
-            large_.capacity_ = len + 1;
-            size_ = len + 1;
-            data = new char[large_.capacity_];
-            std::memcpy(data, str, size_);
-        } else {
-            is_small_ = true;
-            size_ = len + 1;
-            data = &small_[0];
-            std::memcpy(data, str, size_);
-        }
+        init(str, std::strlen(str));
     }
 
-    String() : is_small_(true), size_(1), data(&small_[0]) {
-        data[0] = '\0';
+    //count copies of ch; also a buffer to be filled through data()
+    String(size_t count, char ch) {
+        char* dst = initUninitialized(count);
+        std::memset(dst, ch, count);
+        dst[count] = '\0';
+    }
+
+    //copies the viewed characters
+    explicit String(StringView str) {
+        init(str.data(), str.size());
+    }
+
+    //materializes a chain of operator+ with a single allocation
+    template <typename Lhs, typename Rhs>
+    String(StringConcat<Lhs, Rhs>&& expr) {
+        *expr.copyTo(initUninitialized(expr.size())) = '\0';
     }
 
     String(const String& lval) {
-        if (lval.size() < max_len) {
-            is_small_ = true;
-            size_ = lval.size_;
-            data = &small_[0];
-            std::memcpy(data, lval.c_str(), size_);
-        } else {
-            is_small_ = false;
-            large_.capacity_ = lval.size_;
-            size_ = lval.size_;
-            data = new char[large_.capacity_];
-            std::memcpy(data, lval.c_str(), size_); 
-        }
+        init(lval.data(), lval.size());
     }
 
     String(String&& rval) {
-        if (rval.size() < max_len) {
-            is_small_ = true;
-            size_ = rval.size_;
-            data = &small_[0];
-            std::memcpy(data, rval.c_str(), size_);
-        } else {
-            is_small_ = false;
-            large_.capacity_ = rval.size_;
-            size_ = large_.capacity_;
-            data = rval.data;
-            rval.data = nullptr;
-        }
+        std::memcpy(&large_, &rval.large_, sizeof(Large));
+        std::memset(&rval.large_, 0, sizeof(Large));
     }
-    
+
     ~String() {
-        if (!is_small_ && data != nullptr) {
-            delete[] data;
+        if (isLarge()) {
+            deallocateBytes(large_.data, allocatedBytes());
         }
     }
 
+    //reuses the current buffer when it is big enough
     String& operator=(const String& lval) {
-        if (lval.size() < max_len) {
-            is_small_ = true;
-            size_ = lval.size_;
-            data = &small_[0];
-            std::memcpy(data, lval.c_str(), size_);
-        } else {
-            is_small_ = false;
-            large_.capacity_ = lval.size_;
-            size_ = lval.size_;
-            data = new char[large_.capacity_];
-            std::memcpy(data, lval.c_str(), size_); 
+        if (this == &lval) {
+            return *this;
+        }
+        size_t len = lval.size();
+        if (len > capacity()) {
+            String(lval).swap(*this);
+            return *this;
         }
+        std::memcpy(buffer(), lval.data(), len + 1);
+        setSize(len);
         return *this;
     };
 
+    String& operator=(String&& rval) {
+        if (this == &rval) {
+            return *this;
+        }
+        String(std::move(rval)).swap(*this);
+        return *this;
+    }
+
+    //Large spans all three words, so its bytes carry either form whole
+    void swap(String& other) {
+        unsigned char tmp[sizeof(Large)];
+        std::memcpy(tmp, &large_, sizeof(Large));
+        std::memcpy(&large_, &other.large_, sizeof(Large));
+        std::memcpy(&other.large_, tmp, sizeof(Large));
+    }
+
 
     class Iterator {
       public:
@@ -178,137 +204,451 @@ class String {
 
 
     size_t size() const {
-        return size_ - 1;
+        return isLarge() ? large_.size : small_.size;
     }
     size_t capacity() const {
-        if (is_small_) {
-            return max_len;
-        }
-        return large_.capacity_ - 1;
+        return isLarge() ? allocatedBytes() - 1 : inline_capacity;
     }
 
     char& operator [](int idx) {
-        return data[idx];
+        return buffer()[idx];
     }
     const char& operator [](int idx) const {
-        return data[idx];
+        return data()[idx];
     }
 
     void push_back(const char ch) {
-        size_t pos = prepare_push();
-        data[pos] = ch;
-        data[pos + 1] = '\0';
-        ++size_;
+        size_t len = size();
+        if (len == capacity()) {
+            grow(len + 1);
+        }
+        char* ptr = buffer();
+        ptr[len] = ch;
+        ptr[len + 1] = '\0';
+        setSize(len + 1);
     }
 
     void pop_back() {
-       data[--size_ - 1] = '\0'; 
+        size_t len = size() - 1;
+        buffer()[len] = '\0';
+        setSize(len);
+    }
+
+    //new chars are set to ch; shrinking keeps the buffer
+    void resize(size_t count, char ch = '\0') {
+        size_t len = size();
+        if (count > len) {
+            std::memset(reserve(count - len), ch, count - len);
+        }
+        buffer()[count] = '\0';
+        setSize(count);
     }
 
+    char* data() {
+        return buffer();
+    }
+    const char* data() const {
+        return isLarge() ? large_.data : small_.chars;
+    }
     char* c_str() const {
-        return data;
+        return const_cast<char*>(data());
+    }
+
+    operator StringView() const {
+        return StringView(data(), size());
+    }
+
+    size_t find(char ch, size_t pos = 0) const {
+        return findByte(data(), size(), ch, pos);
+    }
+    size_t find(StringView needle, size_t pos = 0) const {
+        return findBytes(data(), size(), needle.data(), needle.size(), pos);
+    }
+    size_t findFirstOf(const CharSet& set, size_t pos = 0) const {
+        return stdvector::findFirstOf(data(), size(), set, pos);
+    }
+    size_t findFirstOf(StringView chars, size_t pos = 0) const {
+        return findFirstOf(CharSet(chars.data(), chars.size()), pos);
+    }
+    size_t count(char ch) const {
+        return countByte(data(), size(), ch);
     }
 
     String& operator+=(const String& rhs) {
-        char* ptr = reserve(rhs.size_);
-        std::memcpy(ptr, rhs.c_str(), rhs.size_);
-        size_ += rhs.size();
+        append(rhs.data(), rhs.size());
         return *this;
     }
     String& operator+=(const char* rhs) {
-        size_t rhs_size = std::strlen(rhs);
-        char* ptr = reserve(rhs_size + 1);
-        std::memcpy(ptr, rhs, rhs_size + 1);
-        size_ += rhs_size;
+        append(rhs, std::strlen(rhs));
         return *this;
     }
     String& operator+=(const char rhs) {
         push_back(rhs);
         return *this;
     }
+    String& operator+=(StringView rhs) {
+        append(rhs.data(), rhs.size());
+        return *this;
+    }
+    template <typename Lhs, typename Rhs>
+    String& operator+=(StringConcat<Lhs, Rhs>&& expr) {
+        if (expr.aliases(*this)) {
+            return *this += String(std::move(expr));
+        }
+        size_t len = size();
+        size_t expr_size = expr.size();
+        *expr.copyTo(reserve(expr_size)) = '\0';
+        setSize(len + expr_size);
+        return *this;
+    }
+
+    //Number formatting straight into the tail, integers reserve exactly
+    //their length. width pads with leading zeros.
+    String& appendInt(int64_t value, size_t width = 0) {
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        size_t digits = decimalDigits(magnitude);
+        return appendFormatted((value < 0) + (digits > width ? digits : width), [&](char* dst) {
+            return writeInt(dst, value, width);
+        });
+    }
+    String& appendUInt(uint64_t value, size_t width = 0) {
+        size_t digits = decimalDigits(value);
+        return appendFormatted(digits > width ? digits : width, [&](char* dst) {
+            return writeDecimal(dst, value, digits > width ? digits : width);
+        });
+    }
+    String& appendHex(uint64_t value, size_t width = 0, bool upper = false) {
+        size_t digits = hexDigits(value);
+        return appendFormatted(digits > width ? digits : width, [&](char* dst) {
+            return writeHex(dst, value, width, upper);
+        });
+    }
+    //shortest form that parses back to the same value
+    String& appendDouble(double value) {
+        char buf[max_double_chars];
+        append(buf, writeDouble(buf, value) - buf);
+        return *this;
+    }
+    //formatted on the stack, so only the exact length is reserved
+    String& appendFixed(double value, int precision) {
+        char buf[max_fixed_chars];
+        append(buf, writeFixed(buf, value, precision) - buf);
+        return *this;
+    }
 
   private:
-    size_t prepare_push() {
-        if (is_small_) {
-            if (size_ == max_len) {
-                resize_from_small(max_len * 2);
-            }  
+    friend struct detail::StringTail;
+
+    static constexpr size_t inline_capacity = 22;
+    static constexpr size_t large_flag = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    bool isLarge() const {
+        unsigned char tag;
+        std::memcpy(&tag, reinterpret_cast<const unsigned char*>(this) + sizeof(String) - 1, 1);
+        return (tag & 0x80) != 0;
+    }
+    size_t allocatedBytes() const {
+        return large_.capacity & ~large_flag;
+    }
+    char* buffer() const {
+        return isLarge() ? large_.data : const_cast<char*>(small_.chars);
+    }
+    void setSize(size_t len) {
+        if (isLarge()) {
+            large_.size = len;
         } else {
-            if (size_ == large_.capacity_) {
-                resize(large_.capacity_ * 2);
-            }   
+            small_.size = static_cast<unsigned char>(len);
         }
-        return size_ - 1;
     }
 
-    void resize(size_t count) {
-        size_t old_capacity = large_.capacity_;
-        large_.capacity_ = count;
-        char* new_data = new char[large_.capacity_];
-        std::memcpy(new_data, data, old_capacity);
-        delete[] data;
-        data = new_data;
+    //sets up storage for len chars, the caller writes them and the \0
+    char* initUninitialized(size_t len) {
+        if (len > inline_capacity) {
+            large_.data = static_cast<char*>(allocateBytes(len + 1));
+            large_.size = len;
+            large_.capacity = (len + 1) | large_flag;
+            return large_.data;
+        }
+        std::memset(&large_, 0, sizeof(Large));
+        small_.size = static_cast<unsigned char>(len);
+        return small_.chars;
+    }
+    void init(const char* src, size_t len) {
+        char* dst = initUninitialized(len);
+        if (len > 0) {
+            std::memcpy(dst, src, len);
+        }
+        dst[len] = '\0';
     }
 
-    void resize_from_small(size_t count) {
-        char* new_data = new char[count];
-        std::memcpy(new_data, data, max_len);
-        large_.capacity_ = count;
-        data = new_data;
-        is_small_ = false;
-    }  
+    //moves to a heap buffer for at least min_len chars, doubling capacity
+    void grow(size_t min_len) {
+        size_t len = size();
+        size_t new_capacity = capacity() * 2 > min_len ? capacity() * 2 : min_len;
+        char* new_data = static_cast<char*>(allocateBytes(new_capacity + 1));
+        std::memcpy(new_data, data(), len + 1);
+        if (isLarge()) {
+            deallocateBytes(large_.data, allocatedBytes());
+        }
+        large_.data = new_data;
+        large_.size = len;
+        large_.capacity = (new_capacity + 1) | large_flag;
+    }
 
+    //room for count more chars and the \0, returns the current end
     char* reserve(size_t count) {
-        std::cout << "reserving " << count << " bytes\n";
-        if (is_small_) {
-            if (size_ + count >= max_len) {
-                resize_from_small(max_len + count);
-            }
-        } else {
-            if ((size_ + count >= large_.capacity_) && (size_ + count < large_.capacity_ * 2)) {
-                resize(large_.capacity_ * 2);
-            } else {
-                resize(large_.capacity_ + count);
-            }
+        size_t len = size();
+        if (len + count > capacity()) {
+            grow(len + count);
         }
-        return data + size_ - 1;
+        return buffer() + len;
     }
 
-    static const size_t max_len = 16;
+    //write gets room for max_chars and returns the end of what it wrote;
+    //may grow the buffer past what ends up used
+    template <typename Write>
+    String& appendFormatted(size_t max_chars, Write&& write) {
+        size_t len = size();
+        char* begin = reserve(max_chars);
+        char* end = write(begin);
+        *end = '\0';
+        setSize(len + (end - begin));
+        return *this;
+    }
+
+    //src may point into this string
+    void append(const char* src, size_t count) {
+        size_t len = size();
+        std::less_equal<const char*> less_equal;
+        if (len + count > capacity() && less_equal(data(), src) && less_equal(src, data() + len)) {
+            append(String(StringView(src, count)).data(), count);
+            return;
+        }
+        char* dst = reserve(count);
+        if (count > 0) {
+            std::memcpy(dst, src, count);
+        }
+        dst[count] = '\0';
+        setSize(len + count);
+    }
+
+    struct Large {
+        char* data;
+        size_t size;
+        size_t capacity;    //bytes allocated, with \0, or'ed with large_flag
+    };
+    struct Small {
+        char chars[sizeof(Large) - 1];
+        unsigned char size;
+    };
 
-    char* data;                 //always valid
-    size_t size_;               //size with \0
     union {
-        struct {
-            size_t capacity_;   //capa with \0
-            char padding[8];
-        } large_;
-        char small_[sizeof(large_)];
+        Large large_;
+        Small small_;
     };
-    bool is_small_;
 };
 
-std::ostream& operator<<(std::ostream& out, String& str) {
+static_assert(sizeof(String) == 3 * sizeof(size_t), "String must stay three words");
+
+namespace detail {
+
+//For writers that fill the spare room past a String's end themselves
+//(transcoders, codecs): grow makes room for count more chars and returns
+//where they go, without initializing them; commit then sets the size to
+//what was actually written, or back to the old size on failure.
+struct StringTail {
+    static char* grow(String& str, size_t count) {
+        return str.reserve(count);
+    }
+    static void commit(String& str, size_t size) {
+        str.buffer()[size] = '\0';
+        str.setSize(size);
+    }
+    //whether src points into str, so that grow may free it
+    static bool aliases(const String& str, const void* src) {
+        std::less_equal<const char*> less_equal;
+        const char* ptr = static_cast<const char*>(src);
+        return less_equal(str.data(), ptr) && less_equal(ptr, str.data() + str.size());
+    }
+};
+
+} //namespace detail
+
+//memcpy is a valid move for String, containers may relocate it as raw bytes
+template <>
+struct IsTriviallyRelocatable<String> : std::true_type {};
+
+inline std::ostream& operator<<(std::ostream& out, const String& str) {
     out << str.c_str();
     return out;
 }
 
-String operator+(const String& lhs, const String& rhs) {
-    String tmp(lhs);
-    tmp += rhs;
-    return tmp;
+inline bool operator==(const String& lhs, const String& rhs) {
+    return lhs.size() == rhs.size() && equalBytes(lhs.c_str(), rhs.c_str(), lhs.size());
+}
+inline bool operator==(const String& lhs, const char* rhs) {
+    return std::strcmp(lhs.c_str(), rhs) == 0;
+}
+inline bool operator==(const char* lhs, const String& rhs) {
+    return std::strcmp(lhs, rhs.c_str()) == 0;
+}
+inline bool operator!=(const String& lhs, const String& rhs) {
+    return !(lhs == rhs);
+}
+inline bool operator!=(const String& lhs, const char* rhs) {
+    return !(lhs == rhs);
+}
+inline bool operator!=(const char* lhs, const String& rhs) {
+    return !(lhs == rhs);
+}
+
+//lexicographic by unsigned bytes, same as strcmp
+inline bool operator<(const String& lhs, const String& rhs) {
+    size_t len = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+    int res = compareBytes(lhs.c_str(), rhs.c_str(), len);
+    return res < 0 || (res == 0 && lhs.size() < rhs.size());
+}
+inline bool operator<(const String& lhs, const char* rhs) {
+    return std::strcmp(lhs.c_str(), rhs) < 0;
+}
+inline bool operator<(const char* lhs, const String& rhs) {
+    return std::strcmp(lhs, rhs.c_str()) < 0;
+}
+
+//Pieces of a concatenation: strings are referenced, C strings measured once.
+struct StringPiece {
+    const String& str;
+
+    size_t size() const {
+        return str.size();
+    }
+    char* copyTo(char* dst) const {
+        std::memcpy(dst, str.c_str(), str.size());
+        return dst + str.size();
+    }
+    bool aliases(const String& target) const {
+        return &str == &target;
+    }
+};
+
+struct CStringPiece {
+    const char* str;
+    size_t len;
+
+    size_t size() const {
+        return len;
+    }
+    char* copyTo(char* dst) const {
+        std::memcpy(dst, str, len);
+        return dst + len;
+    }
+    bool aliases(const String& target) const {
+        std::less_equal<const char*> less_equal;
+        return less_equal(target.c_str(), str) && less_equal(str, target.c_str() + target.size());
+    }
+};
+
+//Lazy result of a + b + c...: nothing is copied until it is converted to a
+//String (or appended with +=), which then allocates once for the total
+//length. Holds references to its operands and to the inner temporaries of
+//the chain, so it only exists as an rvalue: it can't be copied or moved,
+//and String, += and + accept it only as a temporary. auto s = a + b
+//compiles, but every use of s afterwards does not.
+template <typename Lhs, typename Rhs>
+class [[nodiscard]] StringConcat {
+  public:
+    StringConcat(const Lhs& lhs, const Rhs& rhs) : lhs_(lhs), rhs_(rhs), size_(lhs.size() + rhs.size()) {}
+
+    StringConcat(const StringConcat&) = delete;
+    StringConcat(StringConcat&&) = delete;
+    StringConcat& operator=(const StringConcat&) = delete;
+    StringConcat& operator=(StringConcat&&) = delete;
+
+  private:
+    friend class String;
+    template <typename Expr>
+    friend struct ConcatPiece;
+
+    size_t size() const {
+        return size_;
+    }
+    char* copyTo(char* dst) const {
+        return rhs_.copyTo(lhs_.copyTo(dst));
+    }
+    bool aliases(const String& target) const {
+        return lhs_.aliases(target) || rhs_.aliases(target);
+    }
+
+    Lhs lhs_;
+    Rhs rhs_;
+    size_t size_;
+};
+
+//an inner link of a chain, alive until the end of the full expression
+template <typename Expr>
+struct ConcatPiece {
+    const Expr& expr;
+
+    size_t size() const {
+        return expr.size();
+    }
+    char* copyTo(char* dst) const {
+        return expr.copyTo(dst);
+    }
+    bool aliases(const String& target) const {
+        return expr.aliases(target);
+    }
+};
+
+inline CStringPiece makeStringPiece(StringView str) {
+    return CStringPiece{str.data(), str.size()};
+}
+inline StringPiece makeStringPiece(const String& str) {
+    return StringPiece{str};
+}
+inline CStringPiece makeStringPiece(const char* str) {
+    return CStringPiece{str, std::strlen(str)};
+}
+//no const& overload: a named StringConcat can't join another chain
+template <typename Lhs, typename Rhs>
+inline ConcatPiece<StringConcat<Lhs, Rhs>> makeStringPiece(StringConcat<Lhs, Rhs>&& expr) {
+    return ConcatPiece<StringConcat<Lhs, Rhs>>{expr};
 }
 
-String operator+(const String& lhs, const char* rhs) {
-    String tmp(lhs);
-    tmp += rhs;
-    return tmp;
+template <typename T>
+struct IsStringExpr : std::false_type {};
+template <>
+struct IsStringExpr<String> : std::true_type {};
+template <>
+struct IsStringExpr<StringView> : std::true_type {};
+template <typename Lhs, typename Rhs>
+struct IsStringExpr<StringConcat<Lhs, Rhs>> : std::true_type {};
+
+template <typename T>
+struct IsStringOperand
+    : std::integral_constant<bool, IsStringExpr<T>::value ||
+                                   std::is_convertible<const T&, const char*>::value> {};
+
+//T as deduced by a forwarding reference; fails for an lvalue StringConcat
+template <typename T>
+using StringPieceOf = typename std::decay<decltype(makeStringPiece(std::declval<T>()))>::type;
+
+template <typename Lhs, typename Rhs,
+          typename = typename std::enable_if<(IsStringExpr<typename std::decay<Lhs>::type>::value ||
+                                              IsStringExpr<typename std::decay<Rhs>::type>::value) &&
+                                             IsStringOperand<typename std::decay<Lhs>::type>::value &&
+                                             IsStringOperand<typename std::decay<Rhs>::type>::value>::type>
+inline StringConcat<StringPieceOf<Lhs>, StringPieceOf<Rhs>> operator+(Lhs&& lhs, Rhs&& rhs) {
+    return StringConcat<StringPieceOf<Lhs>, StringPieceOf<Rhs>>(makeStringPiece(std::forward<Lhs>(lhs)),
+                                                               makeStringPiece(std::forward<Rhs>(rhs)));
 }
 
-String operator+(const char* lhs, const String& rhs) {
-    String tmp(lhs);
-    tmp += rhs;
-    return tmp;
+//a temporary on the left keeps its buffer and grows in place
+template <typename Rhs, typename = typename std::enable_if<IsStringOperand<typename std::decay<Rhs>::type>::value>::type,
+          typename = StringPieceOf<Rhs>>
+inline String operator+(String&& lhs, Rhs&& rhs) {
+    lhs += std::forward<Rhs>(rhs);
+    return std::move(lhs);
 }
 
 } //namespace stdvector
\ No newline at end of file
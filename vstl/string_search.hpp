@@ -0,0 +1,340 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define VSTL_SEARCH_AVX2 1
+#endif
+
+//Byte search kernels behind StringView and String. Each one has an AVX2
+//version picked at run time when the CPU has it, an SSE2 version where
+//the target guarantees it and a scalar fallback; they never read past len.
+
+namespace stdvector {
+
+static constexpr size_t search_npos = static_cast<size_t>(-1);
+
+//Set of bytes for findFirstOf. The nibble table answers "is byte b in the
+//set" with two shuffles: row lo = b & 15 holds one bit per high nibble,
+//split over two tables for high nibbles 0-7 and 8-15.
+class CharSet {
+  public:
+    CharSet() : bits_{0, 0, 0, 0}, nibbles_{} {}
+    CharSet(const char* chars, size_t count) : CharSet() {
+        for (size_t i = 0; i < count; ++i) {
+            insert(chars[i]);
+        }
+    }
+
+    void insert(char ch) {
+        unsigned char byte = static_cast<unsigned char>(ch);
+        bits_[byte >> 6] |= uint64_t(1) << (byte & 63);
+        nibbles_[byte >> 7][byte & 15] |= static_cast<uint8_t>(1 << ((byte >> 4) & 7));
+    }
+    bool contains(char ch) const {
+        unsigned char byte = static_cast<unsigned char>(ch);
+        return (bits_[byte >> 6] >> (byte & 63)) & 1;
+    }
+
+    const uint8_t* nibbles(size_t upper) const {
+        return nibbles_[upper];
+    }
+
+  private:
+    uint64_t bits_[4];
+    uint8_t nibbles_[2][16];
+};
+
+inline unsigned countTrailingZeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    unsigned count = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned popCount(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(mask);
+#else
+    unsigned count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline bool cpuHasAvx2() {
+#ifdef VSTL_SEARCH_AVX2
+    static const bool avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+//pshufb for the 16 byte lookup table kernels
+inline bool cpuHasSsse3() {
+#ifdef VSTL_SEARCH_AVX2
+    static const bool ssse3 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3") != 0;
+    }();
+    return ssse3;
+#else
+    return false;
+#endif
+}
+
+#ifdef VSTL_SEARCH_AVX2
+
+__attribute__((target("avx2"))) inline size_t findByteAvx2(const char* data, size_t len, char ch, size_t& pos) {
+    __m256i needle = _mm256_set1_epi8(ch);
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return pos + countTrailingZeros(mask);
+        }
+    }
+    return search_npos;
+}
+
+//candidates must match the first and the last byte of the needle
+__attribute__((target("avx2"))) inline size_t findBytesAvx2(const char* data, size_t len,
+                                                             const char* needle, size_t needle_len, size_t& pos) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    for (; pos + needle_len - 1 + 32 <= len; pos += 32) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + needle_len - 1));
+        __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(both));
+        for (; mask != 0; mask &= mask - 1) {
+            size_t at = pos + countTrailingZeros(mask);
+            if (std::memcmp(data + at + 1, needle + 1, needle_len - 2) == 0) {
+                return at;
+            }
+        }
+    }
+    return search_npos;
+}
+
+__attribute__((target("avx2"))) inline size_t findFirstOfAvx2(const char* data, size_t len, const CharSet& set, size_t& pos) {
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.nibbles(0))));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.nibbles(1))));
+    const __m256i bit_table = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                               1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+    const __m256i seven = _mm256_set1_epi8(7);
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i lo = _mm256_and_si256(block, nibble_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble_mask);
+        __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_table, lo), _mm256_shuffle_epi8(high_table, lo),
+                                         _mm256_cmpgt_epi8(hi, seven));
+        __m256i bit = _mm256_shuffle_epi8(bit_table, hi);
+        __m256i hit = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return pos + countTrailingZeros(mask);
+        }
+    }
+    return search_npos;
+}
+
+__attribute__((target("avx2"))) inline size_t countByteAvx2(const char* data, size_t len, char ch, size_t& pos) {
+    __m256i needle = _mm256_set1_epi8(ch);
+    size_t count = 0;
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        count += popCount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))));
+    }
+    return count;
+}
+
+//index of the first differing byte, or search_npos
+__attribute__((target("avx2"))) inline size_t mismatchAvx2(const char* lhs, const char* rhs, size_t len, size_t& pos) {
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + pos));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if (mask != 0xffffffffu) {
+            return pos + countTrailingZeros(~mask);
+        }
+    }
+    return search_npos;
+}
+
+#endif //VSTL_SEARCH_AVX2
+
+//Each kernel below runs the widest loop available from pos, then finishes
+//the remainder with the next narrower one. A pos past the end returns
+//search_npos up front, the block bounds below would wrap around for it.
+
+inline size_t findByte(const char* data, size_t len, char ch, size_t pos = 0) {
+    if (pos >= len) {
+        return search_npos;
+    }
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        size_t found = findByteAvx2(data, len, ch, pos);
+        if (found != search_npos) {
+            return found;
+        }
+    }
+#endif
+#ifdef __SSE2__
+    __m128i needle = _mm_set1_epi8(ch);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return pos + countTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; pos < len; ++pos) {
+        if (data[pos] == ch) {
+            return pos;
+        }
+    }
+    return search_npos;
+}
+
+inline size_t findBytes(const char* data, size_t len, const char* needle, size_t needle_len, size_t pos = 0) {
+    if (needle_len == 0) {
+        return pos <= len ? pos : search_npos;
+    }
+    if (needle_len > len || pos > len - needle_len) {
+        return search_npos;
+    }
+    if (needle_len == 1) {
+        return findByte(data, len, needle[0], pos);
+    }
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        size_t found = findBytesAvx2(data, len, needle, needle_len, pos);
+        if (found != search_npos) {
+            return found;
+        }
+    }
+#endif
+#ifdef __SSE2__
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    for (; pos + needle_len - 1 + 16 <= len; pos += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + needle_len - 1));
+        __m128i both = _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(both));
+        for (; mask != 0; mask &= mask - 1) {
+            size_t at = pos + countTrailingZeros(mask);
+            if (std::memcmp(data + at + 1, needle + 1, needle_len - 2) == 0) {
+                return at;
+            }
+        }
+    }
+#endif
+    for (; pos + needle_len <= len; ++pos) {
+        if (data[pos] == needle[0] && data[pos + needle_len - 1] == needle[needle_len - 1] &&
+            std::memcmp(data + pos + 1, needle + 1, needle_len - 2) == 0) {
+            return pos;
+        }
+    }
+    return search_npos;
+}
+
+//SSE2 has no byte shuffle, so below AVX2 this is a bitmap lookup per byte
+inline size_t findFirstOf(const char* data, size_t len, const CharSet& set, size_t pos = 0) {
+    if (pos >= len) {
+        return search_npos;
+    }
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        size_t found = findFirstOfAvx2(data, len, set, pos);
+        if (found != search_npos) {
+            return found;
+        }
+    }
+#endif
+    for (; pos < len; ++pos) {
+        if (set.contains(data[pos])) {
+            return pos;
+        }
+    }
+    return search_npos;
+}
+
+inline size_t countByte(const char* data, size_t len, char ch) {
+    size_t pos = 0;
+    size_t count = 0;
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        count += countByteAvx2(data, len, ch, pos);
+    }
+#endif
+#ifdef __SSE2__
+    __m128i needle = _mm_set1_epi8(ch);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        count += popCount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+    }
+#endif
+    for (; pos < len; ++pos) {
+        count += data[pos] == ch;
+    }
+    return count;
+}
+
+//memcmp semantics: sign of the first differing byte taken as unsigned
+inline int compareBytes(const char* lhs, const char* rhs, size_t len) {
+    size_t pos = 0;
+    size_t diff = search_npos;
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        diff = mismatchAvx2(lhs, rhs, len, pos);
+    }
+#endif
+#ifdef __SSE2__
+    for (; diff == search_npos && pos + 16 <= len; pos += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + pos));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+        if (mask != 0xffffu) {
+            diff = pos + countTrailingZeros(~mask);
+        }
+    }
+#endif
+    for (; diff == search_npos && pos < len; ++pos) {
+        if (lhs[pos] != rhs[pos]) {
+            diff = pos;
+        }
+    }
+    if (diff == search_npos) {
+        return 0;
+    }
+    return static_cast<unsigned char>(lhs[diff]) < static_cast<unsigned char>(rhs[diff]) ? -1 : 1;
+}
+
+inline bool equalBytes(const char* lhs, const char* rhs, size_t len) {
+    return compareBytes(lhs, rhs, len) == 0;
+}
+
+} //namespace stdvector
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "allocator.hpp"
+#include "string.hpp"
+#include "string_view.hpp"
+#include "vector2.hpp"
+
+//String sorting by multikey quicksort on cached 8-byte words: every key
+//entry carries the next 8 bytes of its string (big endian, so integer order
+//is byte order), partitions compare those integers and only go back to the
+//characters when a group is equal on all 8 and moves on to the next word.
+//Small groups finish with insertion sort. Ties are broken by original
+//position, so all sorts here are stable.
+//
+//Entries keep lengths and positions in 32 bits: more than 2^32 - 1 strings,
+//or one of 4 GiB or more, throw std::length_error.
+//
+//With threads > 1 big inputs are first split into buckets on their first
+//two bytes, which are then sorted by a set of worker threads.
+
+namespace stdvector {
+
+namespace detail {
+
+struct SortEntry {
+    uint64_t cache;     //bytes depth .. depth + 7, zero padded past the end
+    const char* chars;
+    uint32_t size;      //both checked against UINT32_MAX in makeSortEntries
+    uint32_t idx;       //position before sorting
+};
+
+static constexpr size_t sort_insertion_limit = 16;
+static constexpr size_t sort_parallel_limit = 1 << 16;
+
+inline uint64_t loadSortWord(const char* chars, size_t size, size_t depth) {
+    uint64_t word = 0;
+    if (depth + 8 <= size) {
+        std::memcpy(&word, chars + depth, 8);
+    } else if (depth < size) {
+        std::memcpy(&word, chars + depth, size - depth);
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(word);
+#else
+    uint64_t swapped = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        swapped = (swapped << 8) | ((word >> (8 * i)) & 0xFF);
+    }
+    return swapped;
+#endif
+}
+
+//full comparison, both entries already known equal before depth
+inline bool sortEntryLess(const SortEntry& lhs, const SortEntry& rhs, size_t depth) {
+    if (lhs.cache != rhs.cache) {
+        return lhs.cache < rhs.cache;
+    }
+    size_t common = lhs.size < rhs.size ? lhs.size : rhs.size;
+    if (common > depth + 8) {
+        int cmp = std::memcmp(lhs.chars + depth + 8, rhs.chars + depth + 8, common - depth - 8);
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+    }
+    if (lhs.size != rhs.size) {
+        return lhs.size < rhs.size;
+    }
+    return lhs.idx < rhs.idx;
+}
+
+inline void insertionSort(SortEntry* entries, size_t count, size_t depth) {
+    for (size_t i = 1; i < count; ++i) {
+        SortEntry entry = entries[i];
+        size_t j = i;
+        while (j > 0 && sortEntryLess(entry, entries[j - 1], depth)) {
+            entries[j] = entries[j - 1];
+            --j;
+        }
+        entries[j] = entry;
+    }
+}
+
+inline uint64_t medianOf3(uint64_t a, uint64_t b, uint64_t c) {
+    if (a < b) {
+        return b < c ? b : (a < c ? c : a);
+    }
+    return a < c ? a : (b < c ? c : b);
+}
+
+//equal group of a partition: strings ending within the word at depth go
+//first, ordered by length then position; the rest get their next word
+//cached. Returns how many ended.
+inline size_t advanceSortWord(SortEntry* entries, size_t count, size_t depth) {
+    size_t ended = 0;
+    for (size_t k = 0; k < count; ++k) {
+        if (entries[k].size <= depth + 8) {
+            std::swap(entries[k], entries[ended++]);
+        }
+    }
+    std::sort(entries, entries + ended, [](const SortEntry& lhs, const SortEntry& rhs) {
+        return lhs.size != rhs.size ? lhs.size < rhs.size : lhs.idx < rhs.idx;
+    });
+    for (size_t k = ended; k < count; ++k) {
+        entries[k].cache = loadSortWord(entries[k].chars, entries[k].size, depth + 8);
+    }
+    return ended;
+}
+
+//entries share their first depth bytes and have their caches loaded at depth
+inline void multikeySort(SortEntry* entries, size_t count, size_t depth) {
+    struct Group {
+        SortEntry* entries;
+        size_t count;
+        size_t depth;
+    };
+    while (count > sort_insertion_limit) {
+        uint64_t pivot = medianOf3(entries[0].cache, entries[count / 2].cache, entries[count - 1].cache);
+        //three way: [0, lt) less, [lt, gt) equal, [gt, count) greater
+        size_t lt = 0;
+        size_t gt = count;
+        size_t i = 0;
+        while (i < gt) {
+            if (entries[i].cache < pivot) {
+                std::swap(entries[i++], entries[lt++]);
+            } else if (entries[i].cache > pivot) {
+                std::swap(entries[i], entries[--gt]);
+            } else {
+                ++i;
+            }
+        }
+        size_t ended = advanceSortWord(entries + lt, gt - lt, depth);
+
+        //recurse into the two smaller groups and loop on the largest, so
+        //the stack stays logarithmic however the pivots fall
+        Group groups[3] = {{entries, lt, depth},
+                           {entries + gt, count - gt, depth},
+                           {entries + lt + ended, gt - lt - ended, depth + 8}};
+        size_t largest = 0;
+        for (size_t g = 1; g < 3; ++g) {
+            if (groups[g].count > groups[largest].count) {
+                largest = g;
+            }
+        }
+        for (size_t g = 0; g < 3; ++g) {
+            if (g != largest) {
+                multikeySort(groups[g].entries, groups[g].count, groups[g].depth);
+            }
+        }
+        entries = groups[largest].entries;
+        count = groups[largest].count;
+        depth = groups[largest].depth;
+    }
+    insertionSort(entries, count, depth);
+}
+
+inline void sortEntries(SortEntry* entries, size_t count, size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads <= 1 || count < sort_parallel_limit) {
+        multikeySort(entries, count, 0);
+        return;
+    }
+    //stable counting pass on the top 16 bits of the first word
+    static constexpr size_t bucket_count = 1 << 16;
+    Vector<size_t> starts(bucket_count + 1, 0);
+    size_t* bounds = starts.data();
+    for (size_t i = 0; i < count; ++i) {
+        ++bounds[(entries[i].cache >> 48) + 1];
+    }
+    for (size_t b = 0; b < bucket_count; ++b) {
+        bounds[b + 1] += bounds[b];
+    }
+    SortEntry* scattered = static_cast<SortEntry*>(allocateBytes(count * sizeof(SortEntry)));
+    {
+        Vector<size_t> fill(bucket_count);
+        std::memcpy(fill.data(), bounds, bucket_count * sizeof(size_t));
+        for (size_t i = 0; i < count; ++i) {
+            scattered[fill.data()[entries[i].cache >> 48]++] = entries[i];
+        }
+    }
+    std::memcpy(static_cast<void*>(entries), scattered, count * sizeof(SortEntry));
+    deallocateBytes(scattered, count * sizeof(SortEntry));
+
+    std::atomic<size_t> next_bucket(0);
+    auto worker = [&]() {
+        size_t b;
+        while ((b = next_bucket.fetch_add(1, std::memory_order_relaxed)) < bucket_count) {
+            multikeySort(entries + bounds[b], bounds[b + 1] - bounds[b], 0);
+        }
+    };
+    Vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) {
+        pool.pushBack(std::thread(worker));
+    }
+    worker();
+    for (size_t t = 0; t < pool.size(); ++t) {
+        pool.data()[t].join();
+    }
+}
+
+template <typename GetView>
+Vector<SortEntry> makeSortEntries(size_t count, GetView&& get_view) {
+    if (count > UINT32_MAX) {
+        throw std::length_error("sortStrings: too many strings");
+    }
+    Vector<SortEntry> entries(count);
+    for (size_t i = 0; i < count; ++i) {
+        StringView view = get_view(i);
+        if (view.size() > UINT32_MAX) {
+            throw std::length_error("sortStrings: string is too long");
+        }
+        entries.data()[i] = SortEntry{loadSortWord(view.data(), view.size(), 0), view.data(),
+                                      static_cast<uint32_t>(view.size()), static_cast<uint32_t>(i)};
+    }
+    return entries;
+}
+
+//reorders values by the sorted entries, moving each element's bytes once
+template <typename T>
+void applySortOrder(T* values, const Vector<SortEntry>& entries) {
+    static_assert(IsTriviallyRelocatable<T>::value, "sorted values are moved as raw bytes");
+    size_t count = entries.size();
+    T* sorted = static_cast<T*>(allocateBytes(count * sizeof(T)));
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(static_cast<void*>(sorted + i), values + entries.data()[i].idx, sizeof(T));
+    }
+    std::memcpy(static_cast<void*>(values), sorted, count * sizeof(T));
+    deallocateBytes(sorted, count * sizeof(T));
+}
+
+} //namespace detail
+
+//indices that put get_view(0 .. count - 1) in ascending byte order, for
+//anything that can hand out views by index (e.g. a StringTable)
+template <typename GetView>
+Vector<uint32_t> sortedStringOrder(size_t count, GetView&& get_view, size_t threads = 1) {
+    Vector<detail::SortEntry> entries = detail::makeSortEntries(count, get_view);
+    detail::sortEntries(entries.data(), count, threads);
+    Vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        order.data()[i] = entries.data()[i].idx;
+    }
+    return order;
+}
+
+//threads = 0 uses every hardware thread
+inline void sortStrings(String* values, size_t count, size_t threads = 1) {
+    Vector<detail::SortEntry> entries = detail::makeSortEntries(count, [values](size_t i) {
+        return StringView(values[i]);
+    });
+    detail::sortEntries(entries.data(), count, threads);
+    detail::applySortOrder(values, entries);
+}
+
+inline void sortStrings(StringView* values, size_t count, size_t threads = 1) {
+    Vector<detail::SortEntry> entries = detail::makeSortEntries(count, [values](size_t i) {
+        return values[i];
+    });
+    detail::sortEntries(entries.data(), count, threads);
+    detail::applySortOrder(values, entries);
+}
+
+inline void sortStrings(Vector<String>& values, size_t threads = 1) {
+    sortStrings(values.data(), values.size(), threads);
+}
+
+inline void sortStrings(Vector<StringView>& values, size_t threads = 1) {
+    sortStrings(values.data(), values.size(), threads);
+}
+
+} //namespace stdvector
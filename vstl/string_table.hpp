@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "allocator.hpp"
+#include "hash.hpp"
+#include "hash_map.hpp"
+#include "string_search.hpp"
+#include "string_sort.hpp"
+#include "string_view.hpp"
+#include "vector2.hpp"
+
+//Column of strings in two allocations: all characters back to back in one
+//growable byte buffer, and a Vector of offsets where value i spans
+//offsets[i] .. offsets[i + 1]. Access hands out views into the buffer,
+//which stay valid until the next append.
+
+namespace stdvector {
+
+class StringTable {
+  public:
+    StringTable() : chars_(nullptr), bytes_(0), capacity_(0) {
+        offsets_.pushBack(0);
+    }
+    StringTable(const StringTable& other) : StringTable() {
+        reserveBytes(other.bytes_);
+        if (other.bytes_ > 0) {
+            std::memcpy(chars_, other.chars_, other.bytes_);
+        }
+        bytes_ = other.bytes_;
+        offsets_ = other.offsets_;
+    }
+    StringTable(StringTable&& other) : StringTable() {
+        swap(other);
+    }
+    ~StringTable() {
+        deallocateBytes(chars_, capacity_);
+    }
+
+    StringTable& operator=(StringTable other) {
+        swap(other);
+        return *this;
+    }
+
+    void swap(StringTable& other) {
+        std::swap(chars_, other.chars_);
+        std::swap(bytes_, other.bytes_);
+        std::swap(capacity_, other.capacity_);
+        offsets_.swap(other.offsets_);
+    }
+
+    size_t size() const {
+        return offsets_.size() - 1;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    //characters stored, over all values
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    StringView operator [](size_t idx) const {
+        const uint64_t* offsets = offsets_.data();
+        return StringView(chars_ + offsets[idx], offsets[idx + 1] - offsets[idx]);
+    }
+
+    //returns the index of the new value; str may be a view into this table
+    size_t append(StringView str) {
+        reserveFor(str);
+        if (str.size() > 0) {
+            std::memcpy(chars_ + bytes_, str.data(), str.size());
+        }
+        bytes_ += str.size();
+        offsets_.pushBack(bytes_);
+        return size() - 1;
+    }
+
+    //room for this many characters in total, avoids regrowing during a load
+    void reserveBytes(size_t total) {
+        if (total <= capacity_) {
+            return;
+        }
+        size_t new_capacity = capacity_ * 2 > total ? capacity_ * 2 : total;
+        char* new_chars = static_cast<char*>(allocateBytes(new_capacity));
+        if (bytes_ > 0) {
+            std::memcpy(new_chars, chars_, bytes_);
+        }
+        deallocateBytes(chars_, capacity_);
+        chars_ = new_chars;
+        capacity_ = new_capacity;
+    }
+
+    void clear() {
+        bytes_ = 0;
+        offsets_.clear();
+        offsets_.pushBack(0);
+    }
+
+    //Appends every delimiter separated field of text, returns how many. A
+    //delimiter at the very end does not start another (empty) field.
+    size_t appendDelimited(StringView text, char delimiter = '\n') {
+        size_t start = bytes_;
+        reserveFor(text);
+        if (text.size() > 0) {
+            std::memcpy(chars_ + bytes_, text.data(), text.size());
+        }
+        return splitTail(start, start + text.size(), delimiter);
+    }
+
+    //appendDelimited over a whole file, read straight into the buffer
+    size_t loadDelimited(const char* path, char delimiter = '\n') {
+        std::FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("StringTable::loadDelimited: cannot open file");
+        }
+        size_t start = bytes_;
+        size_t end = start;
+        //sized up front when the file is seekable, grown as needed if not
+        if (std::fseek(file, 0, SEEK_END) == 0) {
+            long file_size = std::ftell(file);
+            std::rewind(file);
+            if (file_size > 0) {
+                reserveBytes(end + static_cast<size_t>(file_size) + 1);
+            }
+        }
+        while (true) {
+            if (end == capacity_) {
+                reserveBytes(end + (1 << 20));
+            }
+            size_t got = std::fread(chars_ + end, 1, capacity_ - end, file);
+            end += got;
+            if (got == 0) {
+                break;
+            }
+        }
+        bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+        if (failed) {
+            throw std::runtime_error("StringTable::loadDelimited: read error");
+        }
+        return splitTail(start, end, delimiter);
+    }
+
+    //indices of the values in ascending byte order, equal values keep
+    //their relative order
+    Vector<uint32_t> sortedIndices(size_t threads = 1) const {
+        return sortedStringOrder(size(), [this](size_t idx) {
+            return (*this)[idx];
+        }, threads);
+    }
+
+    //new table with value i taken from index order[i]
+    StringTable permuted(const Vector<uint32_t>& order) const {
+        StringTable result;
+        result.reserveBytes(bytes_);
+        const uint32_t* indices = order.data();
+        for (size_t i = 0; i < order.size(); ++i) {
+            result.append((*this)[indices[i]]);
+        }
+        return result;
+    }
+
+    void sort(size_t threads = 1) {
+        *this = permuted(sortedIndices(threads));
+    }
+
+  private:
+    //room for text behind the last value; text may view the current
+    //buffer, which growing frees, so it is repointed into the new one
+    void reserveFor(StringView& text) {
+        if (bytes_ + text.size() <= capacity_) {
+            return;
+        }
+        std::less_equal<const char*> less_equal;
+        if (chars_ == nullptr || !less_equal(chars_, text.data()) || !less_equal(text.data(), chars_ + bytes_)) {
+            reserveBytes(bytes_ + text.size());
+            return;
+        }
+        size_t offset = text.data() - chars_;
+        reserveBytes(bytes_ + text.size());
+        text = StringView(chars_ + offset, text.size());
+    }
+
+    //chars_[start, end) is unsplit text right after the last value; moves
+    //the fields down over their delimiters and records their ends
+    size_t splitTail(size_t start, size_t end, char delimiter) {
+        size_t count = 0;
+        size_t read = start;
+        size_t write = start;
+        while (read < end) {
+            size_t found = findByte(chars_ + read, end - read, delimiter, 0);
+            size_t len = found == search_npos ? end - read : found;
+            if (write != read && len > 0) {
+                std::memmove(chars_ + write, chars_ + read, len);
+            }
+            write += len;
+            read += len + 1;
+            offsets_.pushBack(write);
+            ++count;
+        }
+        bytes_ = write;
+        return count;
+    }
+
+    char* chars_;
+    size_t bytes_;
+    size_t capacity_;
+    Vector<uint64_t> offsets_;   //size() + 1 entries, the first is 0
+};
+
+//Dictionary encoded column for values with many repeats: each distinct
+//value is stored once in a StringTable and the column itself is a Vector
+//of 32-bit codes into it.
+class DictStringTable {
+  public:
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    size_t size() const {
+        return codes_.size();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    //number of distinct values
+    size_t dictionarySize() const {
+        return values_.size();
+    }
+
+    StringView operator [](size_t idx) const {
+        return values_[codes_.data()[idx]];
+    }
+    uint32_t code(size_t idx) const {
+        return codes_.data()[idx];
+    }
+    StringView value(uint32_t code) const {
+        return values_[code];
+    }
+    const StringTable& dictionary() const {
+        return values_;
+    }
+    const Vector<uint32_t>& codes() const {
+        return codes_;
+    }
+
+    //returns the code of str, adding it to the dictionary if new
+    uint32_t append(StringView str) {
+        uint64_t hash = hasher_(str);
+        uint32_t code = findCode(str, hash);
+        if (code == npos) {
+            code = static_cast<uint32_t>(values_.append(str));
+            uint32_t* head = heads_.find(hash);
+            next_.pushBack(head != nullptr ? *head : npos);
+            heads_.insertOrAssign(hash, code);
+        }
+        codes_.pushBack(code);
+        return code;
+    }
+
+    //npos if str is not in the dictionary
+    uint32_t find(StringView str) const {
+        return findCode(str, hasher_(str));
+    }
+
+    static DictStringTable encode(const StringTable& table) {
+        DictStringTable result;
+        for (size_t i = 0; i < table.size(); ++i) {
+            result.append(table[i]);
+        }
+        return result;
+    }
+
+    StringTable decode() const {
+        StringTable result;
+        for (size_t i = 0; i < size(); ++i) {
+            result.append((*this)[i]);
+        }
+        return result;
+    }
+
+  private:
+    uint32_t findCode(StringView str, uint64_t hash) const {
+        const uint32_t* head = heads_.find(hash);
+        for (uint32_t code = head != nullptr ? *head : npos; code != npos; code = next_.data()[code]) {
+            if (values_[code] == str) {
+                return code;
+            }
+        }
+        return npos;
+    }
+
+    StringTable values_;
+    Vector<uint32_t> codes_;
+    //full hash -> newest code with it, next_ chains to older ones; keyed by
+    //hash rather than by view since the views move when values_ grows
+    HashMap<uint64_t, uint32_t> heads_;
+    Vector<uint32_t> next_;
+    Hash<StringView> hasher_;
+};
+
+} //namespace stdvector
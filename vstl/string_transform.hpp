@@ -0,0 +1,458 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "hash.hpp"
+#include "string.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "utf8.hpp"
+
+//Whole-string transformations for normalization passes: ASCII case
+//mapping and case-insensitive compare/hash, trimming, replacing, and
+//JSON/CSV escaping. Byte-wise kernels follow string_search.hpp: AVX2 when
+//the CPU has it, SSE2 where the target guarantees it, scalar for the rest.
+//Escaping copies unchanged runs found with findFirstOf in one go.
+
+namespace stdvector {
+
+namespace detail {
+
+#ifdef VSTL_SEARCH_AVX2
+
+__attribute__((target("avx2"))) inline void flipAsciiCaseAvx2(const char* src, char* dst, size_t len,
+                                                                char first, size_t& pos) {
+    const __m256i offset = _mm256_set1_epi8(static_cast<char>(first + 128));
+    const __m256i limit = _mm256_set1_epi8(-128 + 26);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + pos));
+        __m256i in_range = _mm256_cmpgt_epi8(limit, _mm256_sub_epi8(block, offset));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + pos),
+                            _mm256_xor_si256(block, _mm256_and_si256(in_range, bit)));
+    }
+}
+
+#endif //VSTL_SEARCH_AVX2
+
+//flips bit 0x20 of every byte in first .. first + 25, i.e. maps one case
+//of ASCII letters to the other; src and dst may be the same
+inline void flipAsciiCase(const char* src, char* dst, size_t len, char first) {
+    size_t pos = 0;
+#ifdef VSTL_SEARCH_AVX2
+    if (cpuHasAvx2()) {
+        flipAsciiCaseAvx2(src, dst, len, first, pos);
+    }
+#endif
+#ifdef __SSE2__
+    //shifted so the range starts at -128, then one signed compare
+    const __m128i offset = _mm_set1_epi8(static_cast<char>(first + 128));
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+        __m128i in_range = _mm_cmplt_epi8(_mm_sub_epi8(block, offset), limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos), _mm_xor_si128(block, _mm_and_si128(in_range, bit)));
+    }
+#endif
+    for (; pos < len; ++pos) {
+        unsigned char byte = static_cast<unsigned char>(src[pos]);
+        dst[pos] = static_cast<char>(static_cast<unsigned char>(byte - first) < 26 ? byte ^ 0x20 : byte);
+    }
+}
+
+inline unsigned char lowerAscii(char ch) {
+    unsigned char byte = static_cast<unsigned char>(ch);
+    return static_cast<unsigned char>(byte - 'A') < 26 ? byte | 0x20 : byte;
+}
+
+//length of the common prefix of lhs and rhs, ignoring ASCII case
+inline size_t mismatchIgnoreCase(const char* lhs, const char* rhs, size_t len) {
+    size_t pos = 0;
+#ifdef __SSE2__
+    const __m128i offset = _mm_set1_epi8(static_cast<char>('A' + 128));
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + pos));
+        __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + pos));
+        left = _mm_or_si128(left, _mm_and_si128(_mm_cmplt_epi8(_mm_sub_epi8(left, offset), limit), bit));
+        right = _mm_or_si128(right, _mm_and_si128(_mm_cmplt_epi8(_mm_sub_epi8(right, offset), limit), bit));
+        uint32_t diff = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(left, right))) ^ 0xFFFF;
+        if (diff != 0) {
+            return pos + countTrailingZeros(diff);
+        }
+    }
+#endif
+    while (pos < len && lowerAscii(lhs[pos]) == lowerAscii(rhs[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+inline bool isAsciiSpace(char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+} //namespace detail
+
+inline void toLowerAscii(String& str) {
+    detail::flipAsciiCase(str.data(), str.data(), str.size(), 'A');
+}
+inline void toUpperAscii(String& str) {
+    detail::flipAsciiCase(str.data(), str.data(), str.size(), 'a');
+}
+inline String asciiLower(StringView str) {
+    String result;
+    detail::flipAsciiCase(str.data(), detail::StringTail::grow(result, str.size()), str.size(), 'A');
+    detail::StringTail::commit(result, str.size());
+    return result;
+}
+inline String asciiUpper(StringView str) {
+    String result;
+    detail::flipAsciiCase(str.data(), detail::StringTail::grow(result, str.size()), str.size(), 'a');
+    detail::StringTail::commit(result, str.size());
+    return result;
+}
+
+inline bool equalsIgnoreCase(StringView lhs, StringView rhs) {
+    return lhs.size() == rhs.size() && detail::mismatchIgnoreCase(lhs.data(), rhs.data(), lhs.size()) == lhs.size();
+}
+
+//<0, 0 or >0 like compare, on lower cased bytes
+inline int compareIgnoreCase(StringView lhs, StringView rhs) {
+    size_t common = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+    size_t pos = detail::mismatchIgnoreCase(lhs.data(), rhs.data(), common);
+    if (pos < common) {
+        return detail::lowerAscii(lhs[pos]) < detail::lowerAscii(rhs[pos]) ? -1 : 1;
+    }
+    return lhs.size() == rhs.size() ? 0 : (lhs.size() < rhs.size() ? -1 : 1);
+}
+
+//equal for strings that differ only in ASCII case
+inline uint64_t hashIgnoreCase(StringView str) {
+    static constexpr size_t stack_limit = 256;
+    if (str.size() <= stack_limit) {
+        char lowered[stack_limit];
+        detail::flipAsciiCase(str.data(), lowered, str.size(), 'A');
+        return hashBytes(lowered, str.size());
+    }
+    String lowered = asciiLower(str);
+    return hashBytes(lowered.data(), lowered.size());
+}
+
+//for HashMap<String, Value, HashIgnoreCase, EqualIgnoreCase>
+struct HashIgnoreCase {
+    using is_transparent = void;
+
+    uint64_t operator()(StringView str) const {
+        return hashIgnoreCase(str);
+    }
+};
+
+struct EqualIgnoreCase {
+    using is_transparent = void;
+
+    bool operator()(StringView lhs, StringView rhs) const {
+        return equalsIgnoreCase(lhs, rhs);
+    }
+};
+
+//without leading and/or trailing ASCII whitespace
+inline StringView trimLeft(StringView str) {
+    size_t pos = 0;
+    while (pos < str.size() && detail::isAsciiSpace(str[pos])) {
+        ++pos;
+    }
+    return str.substr(pos);
+}
+inline StringView trimRight(StringView str) {
+    size_t len = str.size();
+    while (len > 0 && detail::isAsciiSpace(str[len - 1])) {
+        --len;
+    }
+    return str.substr(0, len);
+}
+inline StringView trim(StringView str) {
+    return trimRight(trimLeft(str));
+}
+
+inline void trimInPlace(String& str) {
+    StringView kept = trim(str);
+    size_t len = kept.size();
+    if (kept.data() != str.data() && len > 0) {
+        std::memmove(str.data(), kept.data(), len);
+    }
+    str.resize(len);
+}
+
+//every from byte becomes to, in place
+inline void replaceAll(String& str, char from, char to) {
+    char* data = str.data();
+    size_t len = str.size();
+    size_t pos = 0;
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8(from);
+    const __m128i replacement = _mm_set1_epi8(to);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i hit = _mm_cmpeq_epi8(block, needle);
+        if (_mm_movemask_epi8(hit) != 0) {
+            block = _mm_or_si128(_mm_andnot_si128(hit, block), _mm_and_si128(hit, replacement));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + pos), block);
+        }
+    }
+#endif
+    for (; pos < len; ++pos) {
+        if (data[pos] == from) {
+            data[pos] = to;
+        }
+    }
+}
+
+//copy with every non-overlapping from (left to right) replaced by to; the
+//result is sized exactly before anything is copied
+inline String replaceAll(StringView str, StringView from, StringView to) {
+    if (from.empty()) {
+        return String(str);
+    }
+    size_t count = 0;
+    for (size_t pos = str.find(from); pos != StringView::npos; pos = str.find(from, pos + from.size())) {
+        ++count;
+    }
+    size_t result_size = str.size() - count * from.size() + count * to.size();
+    String result;
+    char* out = detail::StringTail::grow(result, result_size);
+    size_t last = 0;
+    for (size_t pos = str.find(from); pos != StringView::npos; pos = str.find(from, pos + from.size())) {
+        std::memcpy(out, str.data() + last, pos - last);
+        out += pos - last;
+        if (to.size() > 0) {
+            std::memcpy(out, to.data(), to.size());
+        }
+        out += to.size();
+        last = pos + from.size();
+    }
+    if (str.size() > last) {
+        std::memcpy(out, str.data() + last, str.size() - last);
+    }
+    detail::StringTail::commit(result, result_size);
+    return result;
+}
+
+namespace detail {
+
+inline const CharSet& jsonSpecialChars() {
+    static const CharSet set = [] {
+        CharSet chars("\"\\", 2);
+        for (int ch = 0; ch < 0x20; ++ch) {
+            chars.insert(static_cast<char>(ch));
+        }
+        return chars;
+    }();
+    return set;
+}
+
+inline int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    unsigned char lower = static_cast<unsigned char>(ch) | 0x20;
+    return lower >= 'a' && lower <= 'f' ? lower - 'a' + 10 : -1;
+}
+
+//four hex digits at str[pos], -1 if they are not
+inline long parseHex4(StringView str, size_t pos) {
+    if (str.size() - pos < 4) {
+        return -1;
+    }
+    long value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        int digit = hexValue(str[pos + i]);
+        if (digit < 0) {
+            return -1;
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+} //namespace detail
+
+//JSON string contents (no surrounding quotes): quote, backslash and
+//control characters escaped, everything else copied as is. Like the other
+//append functions below, str may be a view of out.
+inline void appendJsonEscaped(String& out, StringView str) {
+    if (detail::StringTail::aliases(out, str.data())) {
+        appendJsonEscaped(out, String(str));
+        return;
+    }
+    const CharSet& special = detail::jsonSpecialChars();
+    size_t last = 0;
+    for (size_t pos = str.findFirstOf(special); pos != StringView::npos; pos = str.findFirstOf(special, last)) {
+        out += str.substr(last, pos - last);
+        char ch = str[pos];
+        switch (ch) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        default:
+            out += "\\u00";
+            out.appendHex(static_cast<unsigned char>(ch), 2);
+            break;
+        }
+        last = pos + 1;
+    }
+    out += str.substr(last);
+}
+
+inline String jsonEscape(StringView str) {
+    String result;
+    appendJsonEscaped(result, str);
+    return result;
+}
+
+//Decodes escapes in JSON string contents, \u escapes (and surrogate pairs)
+//to UTF-8. Returns search_npos, or the offset of the first bad escape or
+//raw control character, in which case out is left unchanged.
+inline size_t appendJsonUnescaped(String& out, StringView str) {
+    if (detail::StringTail::aliases(out, str.data())) {
+        return appendJsonUnescaped(out, String(str));
+    }
+    size_t old_size = out.size();
+    const CharSet& special = detail::jsonSpecialChars();
+    size_t last = 0;
+    for (size_t pos = str.findFirstOf(special); pos != StringView::npos; pos = str.findFirstOf(special, last)) {
+        out += str.substr(last, pos - last);
+        if (str[pos] != '\\' || pos + 1 == str.size()) {
+            out.resize(old_size);
+            return pos;
+        }
+        char ch = str[pos + 1];
+        last = pos + 2;
+        switch (ch) {
+        case '"':
+        case '\\':
+        case '/':
+            out += ch;
+            break;
+        case 'n':
+            out += '\n';
+            break;
+        case 'r':
+            out += '\r';
+            break;
+        case 't':
+            out += '\t';
+            break;
+        case 'b':
+            out += '\b';
+            break;
+        case 'f':
+            out += '\f';
+            break;
+        case 'u': {
+            long unit = detail::parseHex4(str, pos + 2);
+            last = pos + 6;
+            if (unit >= 0xD800 && unit <= 0xDBFF && str.size() - last >= 6 && str[last] == '\\' &&
+                str[last + 1] == 'u') {
+                long low = detail::parseHex4(str, last + 2);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                    last += 6;
+                }
+            }
+            if (unit < 0 || (unit >= 0xD800 && unit <= 0xDFFF)) {
+                out.resize(old_size);
+                return pos;
+            }
+            char encoded[4];
+            out += StringView(encoded, detail::encodeUtf8(static_cast<char32_t>(unit), encoded) - encoded);
+            break;
+        }
+        default:
+            out.resize(old_size);
+            return pos;
+        }
+    }
+    out += str.substr(last);
+    return search_npos;
+}
+
+//Appends a CSV field, quoted (with inner quotes doubled) only when it
+//holds the delimiter, a quote or a line break.
+inline void appendCsvField(String& out, StringView field, char delimiter = ',') {
+    if (detail::StringTail::aliases(out, field.data())) {
+        appendCsvField(out, String(field), delimiter);
+        return;
+    }
+    const char specials[4] = {delimiter, '"', '\n', '\r'};
+    CharSet special(specials, 4);
+    if (field.findFirstOf(special) == StringView::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    size_t last = 0;
+    for (size_t pos = field.find('"'); pos != StringView::npos; pos = field.find('"', last)) {
+        out += field.substr(last, pos + 1 - last);
+        out += '"';
+        last = pos + 1;
+    }
+    out += field.substr(last);
+    out += '"';
+}
+
+//Inverse of appendCsvField for one field. Returns search_npos, or the
+//offset where a quoted field is malformed, in which case out is left
+//unchanged.
+inline size_t appendCsvUnescaped(String& out, StringView field) {
+    if (detail::StringTail::aliases(out, field.data())) {
+        return appendCsvUnescaped(out, String(field));
+    }
+    if (field.empty() || field[0] != '"') {
+        out += field;
+        return search_npos;
+    }
+    size_t old_size = out.size();
+    size_t last = 1;
+    while (true) {
+        size_t quote = field.find('"', last);
+        if (quote == StringView::npos) {
+            out.resize(old_size);
+            return field.size();
+        }
+        out += field.substr(last, quote - last);
+        if (quote + 1 == field.size()) {
+            return search_npos;
+        }
+        if (field[quote + 1] != '"') {
+            out.resize(old_size);
+            return quote + 1;
+        }
+        out += '"';
+        last = quote + 2;
+    }
+}
+
+} //namespace stdvector
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "string_search.hpp"
+
+//Non-owning view of a character range: a pointer and a length. Substrings
+//and split tokens are views into the same buffer, nothing is copied, so a
+//view must not outlive the characters it points to. Views of a String are
+//not null terminated unless they reach its end.
+
+namespace stdvector {
+
+class StringSplit;
+
+class StringView {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    StringView() : data_(nullptr), size_(0) {}
+    StringView(const char* str) : data_(str), size_(std::strlen(str)) {}
+    StringView(const char* str, size_t len) : data_(str), size_(len) {}
+
+    const char* data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const char& operator [](size_t idx) const {
+        return data_[idx];
+    }
+    const char* begin() const {
+        return data_;
+    }
+    const char* end() const {
+        return data_ + size_;
+    }
+
+    //count is clamped to the end of the view
+    StringView substr(size_t pos, size_t count = npos) const {
+        if (pos > size_) {
+            throw std::out_of_range("StringView::substr");
+        }
+        return StringView(data_ + pos, count < size_ - pos ? count : size_ - pos);
+    }
+
+    void removePrefix(size_t count) {
+        data_ += count;
+        size_ -= count;
+    }
+    void removeSuffix(size_t count) {
+        size_ -= count;
+    }
+
+    size_t find(char ch, size_t pos = 0) const {
+        return findByte(data_, size_, ch, pos);
+    }
+    size_t find(StringView needle, size_t pos = 0) const {
+        return findBytes(data_, size_, needle.data_, needle.size_, pos);
+    }
+
+    //first position holding any of the given characters
+    size_t findFirstOf(const CharSet& set, size_t pos = 0) const {
+        return stdvector::findFirstOf(data_, size_, set, pos);
+    }
+    size_t findFirstOf(StringView chars, size_t pos = 0) const {
+        return findFirstOf(CharSet(chars.data_, chars.size_), pos);
+    }
+
+    size_t count(char ch) const {
+        return countByte(data_, size_, ch);
+    }
+
+    //last match starting at or before pos
+    size_t rfind(char ch, size_t pos = npos) const {
+        if (size_ == 0) {
+            return npos;
+        }
+        for (size_t i = (pos < size_ ? pos : size_ - 1) + 1; i-- > 0;) {
+            if (data_[i] == ch) {
+                return i;
+            }
+        }
+        return npos;
+    }
+    size_t rfind(StringView needle, size_t pos = npos) const {
+        if (needle.size_ > size_) {
+            return npos;
+        }
+        size_t last = size_ - needle.size_;
+        for (size_t i = (pos < last ? pos : last) + 1; i-- > 0;) {
+            if (std::memcmp(data_ + i, needle.data_, needle.size_) == 0) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    bool contains(StringView needle) const {
+        return find(needle) != npos;
+    }
+    bool startsWith(StringView prefix) const {
+        return size_ >= prefix.size_ && std::memcmp(data_, prefix.data_, prefix.size_) == 0;
+    }
+    bool endsWith(StringView suffix) const {
+        return size_ >= suffix.size_ && std::memcmp(data_ + size_ - suffix.size_, suffix.data_, suffix.size_) == 0;
+    }
+
+    //negative, zero or positive like memcmp, shorter prefix first
+    int compare(StringView other) const {
+        size_t len = size_ < other.size_ ? size_ : other.size_;
+        int res = compareBytes(data_, other.data_, len);
+        if (res != 0) {
+            return res;
+        }
+        return size_ < other.size_ ? -1 : (size_ > other.size_ ? 1 : 0);
+    }
+
+    //tokens between delimiters, empty tokens included
+    StringSplit split(char delim) const;
+    StringSplit split(StringView delim) const;
+
+  private:
+    const char* data_;
+    size_t size_;
+};
+
+//Forward range over the tokens of a view; n delimiters give n + 1 tokens.
+class StringSplit {
+  public:
+    class Iterator {
+      public:
+        using value_type = StringView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StringView*;
+        using reference = const StringView&;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator() : done_(true) {}
+        Iterator(StringView rest, StringView delim) : rest_(rest), delim_(delim), done_(false) {
+            advance();
+        }
+
+        reference operator*() const {
+            return token_;
+        }
+        pointer operator->() const {
+            return &token_;
+        }
+
+        Iterator& operator++() {
+            if (last_) {
+                done_ = true;
+            } else {
+                advance();
+            }
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        //only end iterators compare equal
+        bool operator==(const Iterator& it) const {
+            return done_ == it.done_ && (done_ || token_.data() == it.token_.data());
+        }
+        bool operator!=(const Iterator& it) const {
+            return !(*this == it);
+        }
+
+      private:
+        void advance() {
+            size_t pos = delim_.empty() ? StringView::npos : rest_.find(delim_);
+            if (pos == StringView::npos) {
+                token_ = rest_;
+                last_ = true;
+            } else {
+                token_ = rest_.substr(0, pos);
+                rest_.removePrefix(pos + delim_.size());
+                last_ = false;
+            }
+        }
+
+        StringView rest_;
+        StringView delim_;
+        StringView token_;
+        bool last_ = true;
+        bool done_;
+    };
+
+    StringSplit(StringView str, StringView delim) : str_(str), delim_(delim) {}
+
+    Iterator begin() const {
+        return Iterator(str_, delim_);
+    }
+    Iterator end() const {
+        return Iterator();
+    }
+
+  private:
+    StringView str_;
+    StringView delim_;
+};
+
+//every byte value once, so a single char delimiter can be a view that
+//stays valid however the split range is copied
+inline const char* delimiterChars() {
+    struct Table {
+        char chars[256];
+        Table() {
+            for (int i = 0; i < 256; ++i) {
+                chars[i] = static_cast<char>(i);
+            }
+        }
+    };
+    static const Table table;
+    return table.chars;
+}
+
+inline StringSplit StringView::split(StringView delim) const {
+    return StringSplit(*this, delim);
+}
+inline StringSplit StringView::split(char delim) const {
+    return StringSplit(*this, StringView(&delimiterChars()[static_cast<unsigned char>(delim)], 1));
+}
+
+inline bool operator==(StringView lhs, StringView rhs) {
+    return lhs.size() == rhs.size() && equalBytes(lhs.data(), rhs.data(), lhs.size());
+}
+inline bool operator!=(StringView lhs, StringView rhs) {
+    return !(lhs == rhs);
+}
+inline bool operator<(StringView lhs, StringView rhs) {
+    return lhs.compare(rhs) < 0;
+}
+
+inline std::ostream& operator<<(std::ostream& out, StringView str) {
+    out.write(str.data(), str.size());
+    return out;
+}
+
+} //namespace stdvector
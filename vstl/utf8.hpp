@@ -0,0 +1,584 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "string.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+
+//UTF-8 validation, code point counting and transcoding to and from UTF-16
+//and UTF-32. Validation uses the lookup table method of Keiser and Lemire,
+//32 bytes per step on AVX2 and 16 on SSSE3 (no branches per byte), and
+//otherwise skips ASCII runs 16 bytes at a time with SSE2 before a scalar
+//check of the rest.
+//"Valid" means well formed per the Unicode standard: no overlong forms, no
+//surrogates, nothing above U+10FFFF.
+
+namespace stdvector {
+
+namespace detail {
+
+//length of the well formed sequence at pos, 0 if there is none
+inline size_t decodeUtf8(const unsigned char* data, size_t len, size_t pos, char32_t& code_point) {
+    unsigned char lead = data[pos];
+    if (lead < 0x80) {
+        code_point = lead;
+        return 1;
+    }
+    size_t count;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        count = 2;
+        code_point = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        count = 3;
+        code_point = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        count = 4;
+        code_point = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+    if (len - pos < count) {
+        return 0;
+    }
+    //only the second byte has a narrower range
+    unsigned char second = data[pos + 1];
+    if (second < low || second > high) {
+        return 0;
+    }
+    code_point = (code_point << 6) | (second & 0x3F);
+    for (size_t i = 2; i < count; ++i) {
+        unsigned char cont = data[pos + i];
+        if ((cont & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (cont & 0x3F);
+    }
+    return count;
+}
+
+inline size_t findInvalidUtf8Scalar(const char* data, size_t len, size_t pos) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    while (pos < len) {
+#ifdef __SSE2__
+        while (pos + 16 <= len &&
+               _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos))) == 0) {
+            pos += 16;
+        }
+        if (pos == len) {
+            break;
+        }
+#endif
+        char32_t code_point;
+        size_t count = decodeUtf8(bytes, len, pos, code_point);
+        if (count == 0) {
+            return pos;
+        }
+        pos += count;
+    }
+    return search_npos;
+}
+
+#ifdef VSTL_SEARCH_AVX2
+
+//error classes of a (previous byte, byte) pair, see Keiser & Lemire,
+//"Validating UTF-8 In Less Than One Instruction Per Byte"
+static constexpr uint8_t utf8_too_short = 1 << 0;
+static constexpr uint8_t utf8_too_long = 1 << 1;
+static constexpr uint8_t utf8_overlong_3 = 1 << 2;
+static constexpr uint8_t utf8_too_large = 1 << 3;
+static constexpr uint8_t utf8_surrogate = 1 << 4;
+static constexpr uint8_t utf8_overlong_2 = 1 << 5;
+static constexpr uint8_t utf8_too_large_1000 = 1 << 6;
+static constexpr uint8_t utf8_overlong_4 = 1 << 6;
+static constexpr uint8_t utf8_two_conts = 1 << 7;
+static constexpr uint8_t utf8_carry = utf8_too_short | utf8_too_long | utf8_two_conts;
+
+//input shifted right by count bytes, the gap filled from the end of prev
+template <int Count>
+__attribute__((target("avx2"))) inline __m256i previousBytes(__m256i input, __m256i prev) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - Count);
+}
+
+__attribute__((target("avx2"))) inline __m256i highNibbles(__m256i input) {
+    return _mm256_and_si256(_mm256_srli_epi16(input, 4), _mm256_set1_epi8(0x0F));
+}
+
+//errors possible after a byte with this high nibble
+inline const uint8_t* utf8Byte1HighTable() {
+    alignas(16) static const uint8_t table[16] = {
+        utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+        utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+        utf8_two_conts, utf8_two_conts, utf8_two_conts, utf8_two_conts,
+        utf8_too_short | utf8_overlong_2,
+        utf8_too_short,
+        utf8_too_short | utf8_overlong_3 | utf8_surrogate,
+        utf8_too_short | utf8_too_large | utf8_too_large_1000 | utf8_overlong_4,
+    };
+    return table;
+}
+
+//errors possible after a byte with this low nibble
+inline const uint8_t* utf8Byte1LowTable() {
+    alignas(16) static const uint8_t table[16] = {
+        utf8_carry | utf8_overlong_3 | utf8_overlong_2 | utf8_overlong_4,
+        utf8_carry | utf8_overlong_2,
+        utf8_carry,
+        utf8_carry,
+        utf8_carry | utf8_too_large,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000 | utf8_surrogate,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+        utf8_carry | utf8_too_large | utf8_too_large_1000,
+    };
+    return table;
+}
+
+//errors possible for a byte with this high nibble
+inline const uint8_t* utf8Byte2HighTable() {
+    alignas(16) static const uint8_t table[16] = {
+        utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+        utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+        utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_overlong_3 | utf8_too_large_1000 | utf8_overlong_4,
+        utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_overlong_3 | utf8_too_large,
+        utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_surrogate | utf8_too_large,
+        utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_surrogate | utf8_too_large,
+        utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+    };
+    return table;
+}
+
+//non-zero bytes where the block, read after prev, is not valid UTF-8
+__attribute__((target("avx2"))) inline __m256i utf8BlockErrors(__m256i input, __m256i prev) {
+    const __m256i byte_1_high_table =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte1HighTable())));
+    const __m256i byte_1_low_table =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte1LowTable())));
+    const __m256i byte_2_high_table =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte2HighTable())));
+
+    __m256i prev1 = previousBytes<1>(input, prev);
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high_table, highNibbles(prev1)),
+                         _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(byte_2_high_table, highNibbles(input)));
+    //bytes two and three after a 3 or 4 byte lead must be continuations
+    __m256i third = _mm256_subs_epu8(previousBytes<2>(input, prev), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(previousBytes<3>(input, prev), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must_continue, special);
+}
+
+//non-zero if the block ends inside a sequence
+__attribute__((target("avx2"))) inline __m256i utf8Incomplete(__m256i input) {
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    return _mm256_subs_epu8(input, max_value);
+}
+
+//offset of the first bad block, or search_npos if everything is valid
+__attribute__((target("avx2"))) inline size_t findInvalidUtf8BlockAvx2(const char* data, size_t len) {
+    __m256i prev = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i errors;
+        if (_mm256_movemask_epi8(input) == 0) {
+            errors = prev_incomplete;
+        } else {
+            errors = utf8BlockErrors(input, prev);
+        }
+        if (!_mm256_testz_si256(errors, errors)) {
+            return pos;
+        }
+        prev_incomplete = utf8Incomplete(input);
+        prev = input;
+    }
+    //the tail, padded with ASCII so a sequence cut off at the end shows up
+    alignas(32) char tail[32] = {};
+    if (pos < len) {
+        std::memcpy(tail, data + pos, len - pos);
+    }
+    __m256i input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+    //a sequence cut off before the tail shows up as too short against it,
+    //prev_incomplete would also flag one the tail completes
+    __m256i errors = utf8BlockErrors(input, prev);
+    return _mm256_testz_si256(errors, errors) ? search_npos : pos;
+}
+
+//the same kernel 16 bytes at a time, for CPUs without AVX2
+template <int Count>
+__attribute__((target("ssse3"))) inline __m128i previousBytes(__m128i input, __m128i prev) {
+    return _mm_alignr_epi8(input, prev, 16 - Count);
+}
+
+__attribute__((target("ssse3"))) inline __m128i highNibbles(__m128i input) {
+    return _mm_and_si128(_mm_srli_epi16(input, 4), _mm_set1_epi8(0x0F));
+}
+
+__attribute__((target("ssse3"))) inline __m128i utf8BlockErrors(__m128i input, __m128i prev) {
+    const __m128i byte_1_high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte1HighTable()));
+    const __m128i byte_1_low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte1LowTable()));
+    const __m128i byte_2_high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(utf8Byte2HighTable()));
+
+    __m128i prev1 = previousBytes<1>(input, prev);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(byte_1_high_table, highNibbles(prev1)),
+                      _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+        _mm_shuffle_epi8(byte_2_high_table, highNibbles(input)));
+    __m128i third = _mm_subs_epu8(previousBytes<2>(input, prev), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(previousBytes<3>(input, prev), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+    return _mm_xor_si128(must_continue, special);
+}
+
+__attribute__((target("ssse3"))) inline __m128i utf8Incomplete(__m128i input) {
+    const __m128i max_value = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    return _mm_subs_epu8(input, max_value);
+}
+
+//no SSE4.1 testz here, a compare against zero does the same
+__attribute__((target("ssse3"))) inline bool anyNonZero(__m128i value) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) != 0xFFFF;
+}
+
+__attribute__((target("ssse3"))) inline size_t findInvalidUtf8BlockSsse3(const char* data, size_t len) {
+    __m128i prev = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i errors;
+        if (_mm_movemask_epi8(input) == 0) {
+            errors = prev_incomplete;
+        } else {
+            errors = utf8BlockErrors(input, prev);
+        }
+        if (anyNonZero(errors)) {
+            return pos;
+        }
+        prev_incomplete = utf8Incomplete(input);
+        prev = input;
+    }
+    alignas(16) char tail[16] = {};
+    if (pos < len) {
+        std::memcpy(tail, data + pos, len - pos);
+    }
+    __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+    return anyNonZero(utf8BlockErrors(input, prev)) ? pos : search_npos;
+}
+
+#endif //VSTL_SEARCH_AVX2
+
+} //namespace detail
+
+//offset of the first byte that does not start a well formed sequence,
+//search_npos if all of data is valid UTF-8
+inline size_t findInvalidUtf8(const char* data, size_t len) {
+#ifdef VSTL_SEARCH_AVX2
+    size_t block;
+    if (cpuHasAvx2()) {
+        block = detail::findInvalidUtf8BlockAvx2(data, len);
+    } else if (cpuHasSsse3()) {
+        block = detail::findInvalidUtf8BlockSsse3(data, len);
+    } else {
+        return detail::findInvalidUtf8Scalar(data, len, 0);
+    }
+    if (block == search_npos) {
+        return search_npos;
+    }
+    //the error may belong to a sequence started up to 3 bytes before the
+    //block; rescan from the first lead byte among those to get the exact
+    //offset (continuations before it were checked with their lead)
+    size_t pos = block >= 3 ? block - 3 : 0;
+    while (pos < block && (static_cast<unsigned char>(data[pos]) & 0xC0) == 0x80) {
+        ++pos;
+    }
+    return detail::findInvalidUtf8Scalar(data, len, pos);
+#else
+    return detail::findInvalidUtf8Scalar(data, len, 0);
+#endif
+}
+
+inline bool isValidUtf8(StringView str) {
+    return findInvalidUtf8(str.data(), str.size()) == search_npos;
+}
+
+//code points in valid UTF-8: every byte that is not a continuation byte
+inline size_t countCodePoints(const char* data, size_t len) {
+    size_t continuations = 0;
+    size_t pos = 0;
+#ifdef __SSE2__
+    //continuation bytes are exactly those below -64 as signed bytes
+    const __m128i limit = _mm_set1_epi8(-64);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        continuations += popCount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmplt_epi8(block, limit))));
+    }
+#endif
+    for (; pos < len; ++pos) {
+        continuations += (static_cast<unsigned char>(data[pos]) & 0xC0) == 0x80;
+    }
+    return len - continuations;
+}
+
+inline size_t countCodePoints(StringView str) {
+    return countCodePoints(str.data(), str.size());
+}
+
+//error is the source offset of the first unit that could not be converted
+//(search_npos if none); written counts output units up to there
+struct TranscodeResult {
+    size_t written;
+    size_t error;
+};
+
+//dst needs room for len units
+inline TranscodeResult utf8ToUtf16(const char* src, size_t len, char16_t* dst) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(src);
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < len) {
+#ifdef __SSE2__
+        //ASCII runs are widened 16 bytes at a time
+        for (; pos + 16 <= len; pos += 16, out += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+            if (_mm_movemask_epi8(block) != 0) {
+                break;
+            }
+            __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), _mm_unpacklo_epi8(block, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 8), _mm_unpackhi_epi8(block, zero));
+        }
+        if (pos == len) {
+            break;
+        }
+#endif
+        char32_t code_point;
+        size_t count = detail::decodeUtf8(bytes, len, pos, code_point);
+        if (count == 0) {
+            return TranscodeResult{out, pos};
+        }
+        if (code_point >= 0x10000) {
+            code_point -= 0x10000;
+            dst[out++] = static_cast<char16_t>(0xD800 + (code_point >> 10));
+            dst[out++] = static_cast<char16_t>(0xDC00 + (code_point & 0x3FF));
+        } else {
+            dst[out++] = static_cast<char16_t>(code_point);
+        }
+        pos += count;
+    }
+    return TranscodeResult{out, search_npos};
+}
+
+//dst needs room for len code points
+inline TranscodeResult utf8ToUtf32(const char* src, size_t len, char32_t* dst) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(src);
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < len) {
+#ifdef __SSE2__
+        for (; pos + 16 <= len; pos += 16, out += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+            if (_mm_movemask_epi8(block) != 0) {
+                break;
+            }
+            __m128i zero = _mm_setzero_si128();
+            __m128i low = _mm_unpacklo_epi8(block, zero);
+            __m128i high = _mm_unpackhi_epi8(block, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 12), _mm_unpackhi_epi16(high, zero));
+        }
+        if (pos == len) {
+            break;
+        }
+#endif
+        size_t count = detail::decodeUtf8(bytes, len, pos, dst[out]);
+        if (count == 0) {
+            return TranscodeResult{out, pos};
+        }
+        ++out;
+        pos += count;
+    }
+    return TranscodeResult{out, search_npos};
+}
+
+namespace detail {
+
+//code_point must be a scalar value, returns the end of its encoding
+inline char* encodeUtf8(char32_t code_point, char* dst) {
+    if (code_point < 0x80) {
+        *dst++ = static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        *dst++ = static_cast<char>(0xC0 | (code_point >> 6));
+        *dst++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        *dst++ = static_cast<char>(0xE0 | (code_point >> 12));
+        *dst++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        *dst++ = static_cast<char>(0xF0 | (code_point >> 18));
+        *dst++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    return dst;
+}
+
+} //namespace detail
+
+//dst needs room for 3 * len bytes; unpaired surrogates are errors
+inline TranscodeResult utf16ToUtf8(const char16_t* src, size_t len, char* dst) {
+    char* out = dst;
+    size_t pos = 0;
+    while (pos < len) {
+#ifdef __SSE2__
+        //eight ASCII units narrowed at a time
+        for (; pos + 8 <= len; pos += 8, out += 8) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+            if (_mm_movemask_epi8(_mm_cmpgt_epi16(_mm_sub_epi16(block, _mm_set1_epi16(-32768)),
+                                                  _mm_set1_epi16(-32768 + 0x7F))) != 0) {
+                break;
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(block, block));
+        }
+        if (pos == len) {
+            break;
+        }
+#endif
+        char32_t unit = src[pos];
+        if (unit >= 0xD800 && unit <= 0xDFFF) {
+            if (unit > 0xDBFF || pos + 1 == len || src[pos + 1] < 0xDC00 || src[pos + 1] > 0xDFFF) {
+                return TranscodeResult{static_cast<size_t>(out - dst), pos};
+            }
+            unit = 0x10000 + ((unit - 0xD800) << 10) + (src[pos + 1] - 0xDC00);
+            ++pos;
+        }
+        out = detail::encodeUtf8(unit, out);
+        ++pos;
+    }
+    return TranscodeResult{static_cast<size_t>(out - dst), search_npos};
+}
+
+//dst needs room for 4 * len bytes; surrogates and values past U+10FFFF
+//are errors
+inline TranscodeResult utf32ToUtf8(const char32_t* src, size_t len, char* dst) {
+    char* out = dst;
+    for (size_t pos = 0; pos < len; ++pos) {
+        char32_t code_point = src[pos];
+        if (code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            return TranscodeResult{static_cast<size_t>(out - dst), pos};
+        }
+        out = detail::encodeUtf8(code_point, out);
+    }
+    return TranscodeResult{static_cast<size_t>(out - dst), search_npos};
+}
+
+//Append the UTF-8 form to out. On invalid input out is left unchanged and
+//the offset of the first bad unit is returned, search_npos otherwise.
+inline size_t appendUtf16(String& out, const char16_t* src, size_t len) {
+    size_t old_size = out.size();
+    TranscodeResult result = utf16ToUtf8(src, len, detail::StringTail::grow(out, 3 * len));
+    detail::StringTail::commit(out, result.error == search_npos ? old_size + result.written : old_size);
+    return result.error;
+}
+
+inline size_t appendUtf32(String& out, const char32_t* src, size_t len) {
+    size_t old_size = out.size();
+    TranscodeResult result = utf32ToUtf8(src, len, detail::StringTail::grow(out, 4 * len));
+    detail::StringTail::commit(out, result.error == search_npos ? old_size + result.written : old_size);
+    return result.error;
+}
+
+//Walks the code points of a string. Bytes that do not start a well formed
+//sequence come out as U+FFFD one at a time, so iteration always ends.
+class Utf8View {
+  public:
+    class Iterator {
+      public:
+        using value_type = char32_t;
+
+        Iterator(const unsigned char* data, size_t len, size_t pos) : data_(data), len_(len), pos_(pos) {
+            decode();
+        }
+
+        char32_t operator*() const {
+            return code_point_;
+        }
+        Iterator& operator++() {
+            pos_ += length_;
+            decode();
+            return *this;
+        }
+        //byte offset of the current code point
+        size_t offset() const {
+            return pos_;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return pos_ == other.pos_;
+        }
+        bool operator!=(const Iterator& other) const {
+            return pos_ != other.pos_;
+        }
+
+      private:
+        void decode() {
+            if (pos_ >= len_) {
+                length_ = 0;
+                return;
+            }
+            length_ = detail::decodeUtf8(data_, len_, pos_, code_point_);
+            if (length_ == 0) {
+                code_point_ = 0xFFFD;
+                length_ = 1;
+            }
+        }
+
+        const unsigned char* data_;
+        size_t len_;
+        size_t pos_;
+        size_t length_;
+        char32_t code_point_;
+    };
+
+    explicit Utf8View(StringView str) : str_(str) {}
+
+    Iterator begin() const {
+        return Iterator(bytes(), str_.size(), 0);
+    }
+    Iterator end() const {
+        return Iterator(bytes(), str_.size(), str_.size());
+    }
+
+  private:
+    const unsigned char* bytes() const {
+        return reinterpret_cast<const unsigned char*>(str_.data());
+    }
+
+    StringView str_;
+};
+
+} //namespace stdvector
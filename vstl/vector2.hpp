@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <utility>
 #include <iterator>
@@ -6,22 +8,44 @@
 #include <cstring>
 #include <exception>
 #include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include "allocator.hpp"
 
 namespace stdvector {
 
 template <typename T, size_t N>
 class StaticMemory {
   public:
+    StaticMemory() : capacity_(N) {
+        data_ = reinterpret_cast<T*>(storage_);
+    }
+    //constructs exactly count elements, like DynamicMemory
     StaticMemory(size_t count) : capacity_(N) {
         data_ = reinterpret_cast<T*>(storage_);
+        if (count > N) {
+            reallocate();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            new(data_ + i) T();
+        }
     }
     StaticMemory(size_t count, const T& val) : capacity_(N) {
         data_ = reinterpret_cast<T*>(storage_);
-      
-        for (size_t i = 0; i < N; ++i) {
+        if (count > N) {
+            reallocate();
+        }
+        for (size_t i = 0; i < count; ++i) {
             new(data_ + i) T(val);
         }
     }
+    //elements live inside the object, the owner moves them one by one
+    StaticMemory(StaticMemory&&) : capacity_(N) {
+        data_ = reinterpret_cast<T*>(storage_);
+    }
+
+    static const bool owns_heap_buffer = false;
 
   protected:
 
@@ -47,16 +71,24 @@ class StaticMemory {
     void storageRealloc() {
         reallocate();
     }
+    void storageRealloc(size_t, size_t) {
+        reallocate();
+    }
+    void storageReserve(size_t new_capacity, size_t) {
+        if (new_capacity > capacity_) {
+            reallocate();
+        }
+    }
+
+    T* data() const {
+        return data_;
+    }
 
   private:
     uint8_t* rawData() const {
         return storage_;
     }
     
-    T* data() const {
-        return data_;
-    }
-    
     void reallocate() {
         throw std::overflow_error("out of static memory");
     };
@@ -70,12 +102,12 @@ template <typename T, size_t>
 struct DynamicMemory {
   public:
     DynamicMemory() : capacity_(1) {
-        storage_ = new uint8_t[capacity_ * sizeof(T)];
+        storage_ = static_cast<uint8_t*>(allocateBytes(capacity_ * sizeof(T)));
         data_ = reinterpret_cast<T*>(storage_);
     }
 
     DynamicMemory(size_t count) : capacity_(count) {
-        storage_ = new uint8_t[capacity_ * sizeof(T)];
+        storage_ = static_cast<uint8_t*>(allocateBytes(capacity_ * sizeof(T)));
         data_ = reinterpret_cast<T*>(storage_);
         
         for (size_t i = 0; i < count; ++i) {
@@ -84,17 +116,25 @@ struct DynamicMemory {
     }
 
     DynamicMemory(size_t count, const T& val) : capacity_(count) {
-        storage_ = new uint8_t[capacity_ * sizeof(T)];
+        storage_ = static_cast<uint8_t*>(allocateBytes(capacity_ * sizeof(T)));
         data_ = reinterpret_cast<T*>(storage_);
       
         for (size_t i = 0; i < count; ++i) {
             new(data_ + i) T(val);
         }
     }
+    //leaves other without a buffer, the next realloc gives it one
+    DynamicMemory(DynamicMemory&& other) : capacity_(other.capacity_), storage_(other.storage_), data_(other.data_) {
+        other.capacity_ = 0;
+        other.storage_ = nullptr;
+        other.data_ = nullptr;
+    }
     ~DynamicMemory() {
-        delete[] storage_;
+        deallocateBytes(storage_, capacity_ * sizeof(T));
     }
 
+    static const bool owns_heap_buffer = true;
+
   protected:
 
     size_t capacity() const {
@@ -119,7 +159,28 @@ struct DynamicMemory {
     }
 
     void storageRealloc() {
-        reallocate();
+        reallocate(0, capacity_, grownCapacity());
+    }
+    //for ring buffers: only count elements starting at slot first (wrapping
+    //around) are alive, they are moved to the front of the new storage
+    void storageRealloc(size_t first, size_t count) {
+        reallocate(first, count, grownCapacity());
+    }
+    //grows straight to new_capacity, count elements from slot 0 are alive
+    void storageReserve(size_t new_capacity, size_t count) {
+        if (new_capacity > capacity_) {
+            reallocate(0, count, new_capacity);
+        }
+    }
+
+    void storageSwap(DynamicMemory& other) {
+        std::swap(capacity_, other.capacity_);
+        std::swap(storage_, other.storage_);
+        std::swap(data_, other.data_);
+    }
+
+    T* data() const {
+        return data_;
     }
 
   private:
@@ -127,23 +188,33 @@ struct DynamicMemory {
         return storage_;
     }
     
-    T* data() const {
-        return data_;
+    size_t grownCapacity() const {
+        return capacity_ > 0 ? capacity_ * 2 : 1;
     }
-    
-    void reallocate() {
+
+    void reallocate(size_t first, size_t count, size_t new_capacity) {
       size_t old_capacity_ = capacity_;
-      capacity_ *= 2;
+      capacity_ = new_capacity;
 
-      uint8_t* new_storage = new uint8_t[capacity_ * sizeof(T)];
+      uint8_t* new_storage = static_cast<uint8_t*>(allocateBytes(capacity_ * sizeof(T)));
       T* new_data = reinterpret_cast<T*>(new_storage);
 
-      for (size_t i = 0; i < old_capacity_; ++i) {
-        new(new_data + i) T(std::move(data_[i]));
+      if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (count > 0) {
+          size_t first_span = old_capacity_ - first < count ? old_capacity_ - first : count;
+          std::memcpy(static_cast<void*>(new_data), data_ + first, first_span * sizeof(T));
+          std::memcpy(static_cast<void*>(new_data + first_span), data_, (count - first_span) * sizeof(T));
+        }
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          size_t old_idx = (first + i) % old_capacity_;
+          new(new_data + i) T(std::move(data_[old_idx]));
+          data_[old_idx].~T();
+        }
       }
 
       data_ = new_data;
-      delete[] storage_;
+      deallocateBytes(storage_, old_capacity_ * sizeof(T));
       storage_ = new_storage;
     };
 
@@ -155,25 +226,74 @@ struct DynamicMemory {
 template <typename T, size_t N = 0, template <typename, size_t> class Storage = DynamicMemory>
 class Vector : protected Storage<T, N> {
   public:
-    Vector() : size_(0), Storage<T, N>(1) {};
-    Vector(size_t count) : size_(count), Storage<T, N>(count) {};
-    Vector(size_t count, const T& val) : size_(count), Storage<T, N>(count, val) {};
-    Vector(std::initializer_list<T> list) : size_(0), Storage<T, N>(1) {
+    Vector() : Storage<T, N>(), size_(0) {};
+    Vector(size_t count) : Storage<T, N>(count), size_(count) {};
+    Vector(size_t count, const T& val) : Storage<T, N>(count, val), size_(count) {};
+    Vector(std::initializer_list<T> list) : Storage<T, N>(), size_(0) {
         for (const auto& elem: list) {
             this->pushBack(elem);
         }
     }
+    Vector(const Vector& other) : Storage<T, N>(), size_(0) {
+        reserve(other.size());
+        for (size_t i = 0; i < other.size(); ++i) {
+            this->Storage<T, N>::insert(i, other.data()[i]);
+            ++size_;
+        }
+    }
+    //heap storages hand the buffer over, StaticMemory moves element-wise
+    Vector(Vector&& other) : Storage<T, N>(std::move(other)), size_(0) {
+        if constexpr (Storage<T, N>::owns_heap_buffer) {
+            std::swap(size_, other.size_);
+        } else {
+            for (size_t i = 0; i < other.size(); ++i) {
+                this->Storage<T, N>::insert(i, std::move(other.data()[i]));
+                ++size_;
+            }
+            other.clear();
+        }
+    }
+    ~Vector() {
+        clear();
+    }
+
+    Vector& operator=(const Vector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            for (size_t i = 0; i < other.size(); ++i) {
+                this->Storage<T, N>::insert(i, other.data()[i]);
+                ++size_;
+            }
+        }
+        return *this;
+    }
+    Vector& operator=(Vector&& other) {
+        if (this != &other) {
+            clear();
+            if constexpr (Storage<T, N>::owns_heap_buffer) {
+                swap(other);
+            } else {
+                for (size_t i = 0; i < other.size(); ++i) {
+                    this->Storage<T, N>::insert(i, std::move(other.data()[i]));
+                    ++size_;
+                }
+                other.clear();
+            }
+        }
+        return *this;
+    }
 
     class Iterator {
       public:
         using value_type = T;
         using difference_type = std::ptrdiff_t;
-        using pointer = T;
+        using pointer = T*;
         using reference  = T&;
         using iterator_category = std::random_access_iterator_tag;
 
         Iterator() : v_(nullptr), pos_(0) {}   
-        Iterator(Vector<T>* v, size_t start_pos): v_(v), pos_(start_pos) {}
+        Iterator(Vector* v, size_t start_pos): v_(v), pos_(start_pos) {}
         
         reference operator*() {
             return (*v_)[pos_];
@@ -256,25 +376,25 @@ class Vector : protected Storage<T, N> {
         }
 
       private:
-        Vector<T>* v_;
+        Vector* v_;
         size_t pos_;
     };
 
     T& operator [](int idx) {
         if (!check_bounds(idx)) {
-            throw std::out_of_range except("incorrect bounds of idx in vector");
+            throw std::out_of_range("incorrect bounds of idx in vector");
         }
         return this->Storage<T, N>::operator[](idx);
     }
     const T& operator [](int idx) const {
         if (!check_bounds(idx)) {
-            throw std::out_of_range except("incorrect bounds of idx in vector");
+            throw std::out_of_range("incorrect bounds of idx in vector");
         }
         return this->Storage<T, N>::operator[](idx);
     }
 
-    bool check_bounds(ind idx) {
-        return idx >= 0 && idx < this->size();
+    bool check_bounds(int idx) const {
+        return idx >= 0 && static_cast<size_t>(idx) < this->size();
     }
 
     void pushBack(const T& val) {
@@ -293,6 +413,36 @@ class Vector : protected Storage<T, N> {
     }
     void popBack() {
         --size_;
+        data()[size_].~T();
+    }
+
+    //shifts tail one slot right, O(size - idx)
+    void insert(size_t idx, T val) {
+        pushBack(std::move(val));
+        std::rotate(data() + idx, data() + size_ - 1, data() + size_);
+    }
+    void erase(size_t idx) {
+        T* ptr = data();
+        for (size_t i = idx + 1; i < size_; ++i) {
+            ptr[i - 1] = std::move(ptr[i]);
+        }
+        popBack();
+    }
+    void clear() {
+        while (size_ > 0) {
+            popBack();
+        }
+    }
+
+    //grows capacity to at least count in one step
+    void reserve(size_t count) {
+        this->storageReserve(count, size_);
+    }
+
+    //O(1), only for storages that own a heap buffer
+    void swap(Vector& other) {
+        this->storageSwap(other);
+        std::swap(size_, other.size_);
     }
 
     Iterator begin() {
@@ -301,6 +451,13 @@ class Vector : protected Storage<T, N> {
     Iterator end() {
         return Iterator(this, size_);
     }
+
+    T* data() {
+        return this->Storage<T, N>::data();
+    }
+    const T* data() const {
+        return this->Storage<T, N>::data();
+    }
     
     size_t size() const {
         return size_;